@@ -1,4 +1,5 @@
 import QtQuick 2.7
+import QtQuick.Window 2.2
 
 import org.kde.kquickcontrolsaddons 2.0
 import org.kde.plasma.core 2.0 as PlasmaCore
@@ -21,18 +22,29 @@ Item {
     property bool isTopLocation: plasmoid.location == PlasmaCore.Types.TopEdge
     property bool isVerticalOrientation: plasmoid.formFactor == PlasmaCore.Types.Vertical
 
+    property string screenName: Screen.name
+
     VirtualDesktopBar {
         id: backend
 
+        screenName: root.screenName
+        windowNamesShown: config.DesktopLabelsStyle == 3 ||
+                          (config.DesktopLabelsStyle == 4 &&
+                           config.DesktopLabelsStyleCustomFormat.indexOf("$W") != -1)
+
         cfg_EmptyDesktopsRenameAs: config.EmptyDesktopsRenameAs
         cfg_AddingDesktopsExecuteCommand: config.AddingDesktopsExecuteCommand
+        cfg_DesktopLabelsWindowNameRules: config.DesktopLabelsWindowNameRules
         cfg_DynamicDesktopsEnable: config.DynamicDesktopsEnable
+        cfg_DynamicDesktopsRemovalDelay: config.DynamicDesktopsRemovalDelay
+        cfg_DynamicDesktopsMinimumInterval: config.DynamicDesktopsMinimumInterval
         cfg_MultipleScreensFilterOccupiedDesktops: config.MultipleScreensFilterOccupiedDesktops
+        cfg_PerformanceCoalescingInterval: config.PerformanceCoalescingInterval
+        cfg_AnimationsEnable: config.AnimationsEnable
     }
 
     Connections {
         target: backend
-        onDesktopInfoListSent: container.update(desktopInfoList)
         onRequestRenameCurrentDesktop: renamePopup.show(container.currentDesktopButton)
     }
 
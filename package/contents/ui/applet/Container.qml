@@ -26,6 +26,35 @@ GridLayout {
         rowSpacing: parent.rowSpacing
         columnSpacing: parent.columnSpacing
         flow: parent.flow
+
+        Repeater {
+            id: desktopButtonRepeater
+            model: backend.desktopListModel
+            delegate: desktopButtonComponent
+
+            onItemAdded: Qt.callLater(updateDesktopButtonList)
+
+            onItemRemoved: {
+                if (lastHoveredButton == item) {
+                    lastHoveredButton = null;
+                }
+
+                if (currentDesktopButton == item) {
+                    currentDesktopButton = null;
+                }
+
+                if (largestDesktopButton == item) {
+                    largestDesktopButton = null;
+                }
+
+                Qt.callLater(updateDesktopButtonList);
+            }
+        }
+    }
+
+    Connections {
+        target: backend.desktopListModel
+        onRowsMoved: Qt.callLater(updateDesktopButtonList)
     }
 
     AddDesktopButton {}
@@ -80,7 +109,7 @@ GridLayout {
                             return;
                         }
 
-                        backend.replaceDesktops(draggedDesktopButton.number, desktopButton.number);
+                        backend.moveDesktop(draggedDesktopButton.number, desktopButton.number);
                         draggedDesktopButton = desktopButton;
                     }
                 }
@@ -141,34 +170,25 @@ GridLayout {
         }
     }
 
-    function update(desktopInfoList) {
-        var difference = desktopInfoList.length - desktopButtonList.length;
-        var synchronousUpdate = true;
+    function updateDesktopButtonList() {
+        var init = desktopButtonList.length == 0;
 
-        if (difference > 0) {
-            addDesktopButtons(difference);
-        } else if (difference < 0) {
-            removeDesktopButtons(desktopInfoList);
-            synchronousUpdate = !config.AnimationsEnable;
+        // Buttons of removed desktops are only kept around to be hidden
+        var list = [];
+        for (var i = 0; i < desktopButtonRepeater.count; i++) {
+            var desktopButton = desktopButtonRepeater.itemAt(i);
+            if (!desktopButton.isRemoved) {
+                list.push(desktopButton);
+            }
         }
 
-        if (synchronousUpdate) {
-            updateDesktopButtons(desktopInfoList);
-        }
+        var difference = list.length - desktopButtonList.length;
 
+        desktopButtonList = list;
         lastDesktopButton = desktopButtonList[desktopButtonList.length - 1];
-    }
-
-    function addDesktopButtons(difference) {
-        var init = desktopButtonList.length == 0;
-        var temp = difference;
-
-        while (temp-- > 0) {
-            var desktopButton = desktopButtonComponent.createObject(desktopButtonContainer);
-            desktopButtonList.push(desktopButton);
-        }
+        updateNumberOfVisibleDesktopButtons();
 
-        if (!init && difference != 0 &&
+        if (!init && difference > 0 &&
             !config.DynamicDesktopsEnable) {
             if (config.AddingDesktopsSwitchTo) {
                 Utils.delay(100, function() {
@@ -183,76 +203,6 @@ GridLayout {
         }
     }
 
-    function removeDesktopButtons(desktopInfoList) {
-        var list = getRemovedDesktopButtonIndexList(desktopInfoList);
-
-        while (list.length > 0) {
-            var index = list.pop();
-            var desktopButton = desktopButtonList[index];
-            desktopButtonList.splice(index, 1);
-
-            if (lastHoveredButton == desktopButton) {
-                lastHoveredButton = null;
-            }
-
-            if (currentDesktopButton == desktopButton) {
-                currentDesktopButton = null;
-            }
-
-            if (largestDesktopButton == desktopButton) {
-                largestDesktopButton = null;
-            }
-
-            if (config.AnimationsEnable) {
-                desktopButton.hide(function() {
-                    desktopButton.destroy();
-
-                    if (list.length == 0) {
-                        updateDesktopButtons(desktopInfoList);
-                    }
-                }, true);
-                continue;
-            }
-
-            desktopButton.destroy();
-        }
-    }
-
-    function getRemovedDesktopButtonIndexList(desktopInfoList) {
-        var removedDesktopButtonIndexList = [];
-
-        for (var i = 0; i < desktopButtonList.length; i++) {
-            var desktopButton = desktopButtonList[i];
-
-            var keepDesktopButton = false;
-            for (var j = 0; j < desktopInfoList.length; j++) {
-                var desktopInfo = desktopInfoList[j];
-                if (desktopButton.id == desktopInfo.id) {
-                    keepDesktopButton = true;
-                    break;
-                }
-            }
-            if (!keepDesktopButton) {
-                removedDesktopButtonIndexList.push(i);
-            }
-        }
-
-        return removedDesktopButtonIndexList;
-    }
-
-    function updateDesktopButtons(desktopInfoList) {
-        for (var i = 0; i < desktopButtonList.length; i++) {
-            var desktopButton = desktopButtonList[i];
-            var desktopInfo = desktopInfoList[i];
-            desktopButton.update(desktopInfo);
-            desktopButton.show();
-
-            if (desktopButton.isCurrent) {
-                currentDesktopButton = desktopButton;
-            }
-        }
-    }
-
     function updateLargestDesktopButton() {
         var temp = largestDesktopButton;
 
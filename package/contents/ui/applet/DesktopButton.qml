@@ -8,17 +8,33 @@ Component {
     Rectangle {
         readonly property string objectType: "DesktopButton"
 
-        property int number: 0
-        property string id: ""
-        property string name: ""
-        property bool isCurrent: false
-        property bool isEmpty: false
-        property bool isUrgent: false
-        property string activeWindowName: ""
-        property var windowNameList: []
+        property int number: model.number
+        property string id: model.id
+        property string name: model.name
+        property bool isCurrent: model.isCurrent
+        property bool isEmpty: model.isEmpty
+        property bool isUrgent: model.isUrgent
+        property string activeWindowName: model.activeWindowName
+        property int windowCount: model.windowCount
+        property bool isRemoved: model.isRemoved
+
+        onIsCurrentChanged: {
+            if (isCurrent) {
+                container.currentDesktopButton = this;
+            }
+        }
+
+        Component.onCompleted: {
+            if (isCurrent) {
+                container.currentDesktopButton = this;
+            }
+
+            updateLabel();
+            show();
+        }
 
         property bool isDragged: container.draggedDesktopButton == this
-        property bool ignoreMouseArea: container.isDragging
+        property bool ignoreMouseArea: container.isDragging || isRemoved
 
         property bool isVisible: {
             if (config.DesktopButtonsShowOnlyForCurrentDesktop &&
@@ -37,6 +53,9 @@ Component {
         onIsVisibleChanged: {
             container.updateNumberOfVisibleDesktopButtons();
             Qt.callLater(function() {
+                if (isRemoved) {
+                    return;
+                }
                 if (isVisible) {
                     show();
                 } else {
@@ -45,6 +64,17 @@ Component {
             });
         }
 
+        // The row of a removed desktop stays until the button is hidden
+        onIsRemovedChanged: {
+            var removedId = id;
+            Qt.callLater(function() {
+                hide(function() {
+                    backend.desktopListModel.releaseRemovedRow(removedId);
+                }, true);
+                container.updateDesktopButtonList();
+            });
+        }
+
         property alias _label: label
         property alias _indicator: indicator
 
@@ -356,19 +386,6 @@ Component {
             });
         }
 
-        function update(desktopInfo) {
-            number = desktopInfo.number;
-            id = desktopInfo.id;
-            name = desktopInfo.name;
-            isCurrent = desktopInfo.isCurrent;
-            isEmpty = desktopInfo.isEmpty;
-            isUrgent = desktopInfo.isUrgent;
-            activeWindowName = desktopInfo.activeWindowName
-            windowNameList = desktopInfo.windowNameList;
-
-            updateLabel();
-        }
-
         function show() {
             if (!isVisible) {
                 return;
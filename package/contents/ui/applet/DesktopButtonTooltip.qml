@@ -25,7 +25,7 @@ UICommon.TextTooltip {
 
         visualParent = desktopButton;
 
-        var list = desktopButton.windowNameList;
+        var list = backend.getWindowNameList(desktopButton.number);
         if (list.length == 0) {
             content = "No windows";
         }
@@ -32,6 +32,7 @@ Item {
     // Desktop labels
     property alias cfg_DesktopLabelsStyle: desktopLabelsStyleComboBox.currentIndex
     property string cfg_DesktopLabelsStyleCustomFormat
+    property string cfg_DesktopLabelsWindowNameRules
     property string cfg_DesktopLabelsCustomFont
     property int cfg_DesktopLabelsCustomFontSize
     property string cfg_DesktopLabelsCustomColor
@@ -253,6 +254,39 @@ Item {
             }
         }
 
+        RowLayout {
+            CheckBox {
+                id: desktopLabelsWindowNameRulesCheckBox
+                onCheckedChanged: cfg_DesktopLabelsWindowNameRules = checked ?
+                                  desktopLabelsWindowNameRulesTextArea.text : ""
+                text: "Custom rules for window names"
+            }
+
+            HintIcon {
+                tooltipText: "One regular expression per line, applied to window titles<br>
+                              The first one that matches is used, its first captured group becomes the window's name<br>
+                              By default, the part after the last dash is used"
+            }
+        }
+
+        TextArea {
+            id: desktopLabelsWindowNameRulesTextArea
+            visible: desktopLabelsWindowNameRulesCheckBox.checked
+            Layout.fillWidth: true
+            implicitHeight: 80
+            // Set once rather than bound, so clearing all the rules leaves the text area empty,
+            // and before the check box, which takes the rules from it once checked
+            Component.onCompleted: {
+                text = cfg_DesktopLabelsWindowNameRules || "^.* [-–—] (.*)$";
+                desktopLabelsWindowNameRulesCheckBox.checked = cfg_DesktopLabelsWindowNameRules !== "";
+            }
+            onTextChanged: {
+                if (desktopLabelsWindowNameRulesCheckBox.checked) {
+                    cfg_DesktopLabelsWindowNameRules = text;
+                }
+            }
+        }
+
         RowLayout {
             Label {
                 enabled: desktopLabelsMaximumLengthSpinBox.enabled
@@ -15,6 +15,8 @@ Item {
 
     // Dynamic desktops
     property alias cfg_DynamicDesktopsEnable: dynamicDesktopsEnableCheckBox.checked
+    property alias cfg_DynamicDesktopsRemovalDelay: dynamicDesktopsRemovalDelaySpinBox.value
+    property alias cfg_DynamicDesktopsMinimumInterval: dynamicDesktopsMinimumIntervalSpinBox.value
 
     // Multiple screens/monitors
     property alias cfg_MultipleScreensFilterOccupiedDesktops: multipleScreensFilterOccupiedDesktopsCheckBox.checked
@@ -25,6 +27,9 @@ Item {
     property alias cfg_MouseWheelInvertDesktopSwitchingDirection: mouseWheelInvertDesktopSwitchingDirectionCheckBox.checked
     property alias cfg_MouseWheelWrapDesktopNavigationWhenScrolling: mouseWheelWrapDesktopNavigationWhenScrollingCheckBox.checked
 
+    // Performance
+    property alias cfg_PerformanceCoalescingInterval: performanceCoalescingIntervalSpinBox.value
+
     GridLayout {
         columns: 1
 
@@ -134,6 +139,46 @@ Item {
             }
         }
 
+        RowLayout {
+            enabled: dynamicDesktopsEnableCheckBox.checked
+
+            Label {
+                text: "Remove desktops empty for:"
+            }
+
+            SpinBox {
+                id: dynamicDesktopsRemovalDelaySpinBox
+                minimumValue: 0
+                maximumValue: 10000
+                stepSize: 100
+                suffix: " ms"
+            }
+
+            HintIcon {
+                tooltipText: "Keeps desktops emptied only for a moment, e.g. by a closing dialog"
+            }
+        }
+
+        RowLayout {
+            enabled: dynamicDesktopsEnableCheckBox.checked
+
+            Label {
+                text: "Add or remove at most once per:"
+            }
+
+            SpinBox {
+                id: dynamicDesktopsMinimumIntervalSpinBox
+                minimumValue: 0
+                maximumValue: 5000
+                stepSize: 50
+                suffix: " ms"
+            }
+
+            HintIcon {
+                tooltipText: "Changes needed in the meantime are combined into one"
+            }
+        }
+
         SectionHeader {
             text: "Multiple screens/monitors"
         }
@@ -178,5 +223,26 @@ Item {
             enabled: mouseWheelSwitchDesktopOnScrollCheckBox.checked
             text: "Wrap desktop navigation after reaching first or last one"
         }
+
+        SectionHeader {
+            text: "Performance"
+        }
+
+        RowLayout {
+            Label {
+                text: "Group changes within:"
+            }
+
+            SpinBox {
+                id: performanceCoalescingIntervalSpinBox
+                minimumValue: 0
+                maximumValue: 1000
+                suffix: " ms"
+            }
+
+            HintIcon {
+                tooltipText: "Higher values save CPU under heavy window activity, but make the applet react later"
+            }
+        }
     }
 }
@@ -0,0 +1,73 @@
+#include "DBusCallQueue.hpp"
+
+#include <QDBusConnection>
+#include <QDBusPendingCallWatcher>
+
+DBusCallQueue::DBusCallQueue(int maxInFlightCalls, QObject* parent) : QObject(parent),
+        maxInFlightCalls(qMax(1, maxInFlightCalls)),
+        inFlightCallCount(0),
+        stats(nullptr) {}
+
+DBusCallQueue::~DBusCallQueue() {
+    qDeleteAll(callList);
+}
+
+void DBusCallQueue::enqueue(const QDBusMessage& message, Callback callback) {
+    auto* call = new Call;
+    call->message = message;
+    call->callback = callback;
+    callList << call;
+
+    sendPendingCalls();
+}
+
+void DBusCallQueue::setStats(RefreshStats* stats) {
+    this->stats = stats;
+}
+
+void DBusCallQueue::sendPendingCalls() {
+    for (auto* call : callList) {
+        if (inFlightCallCount >= maxInFlightCalls) {
+            break;
+        }
+        if (call->watcher || call->isFinished) {
+            continue;
+        }
+
+        inFlightCallCount++;
+
+        if (stats) {
+            stats->increment(RefreshStats::DBusCallCounter);
+        }
+        call->elapsedTimer.start();
+
+        auto pendingCall = QDBusConnection::sessionBus().asyncCall(call->message);
+        call->watcher = new QDBusPendingCallWatcher(pendingCall, this);
+
+        QObject::connect(call->watcher, &QDBusPendingCallWatcher::finished, this, [this, call] {
+            inFlightCallCount--;
+
+            if (stats) {
+                stats->addSample(RefreshStats::DBusCallStage, call->elapsedTimer.nsecsElapsed());
+            }
+
+            call->isFinished = true;
+            call->reply = call->watcher->reply();
+            call->watcher->deleteLater();
+            call->watcher = nullptr;
+
+            completeFinishedCalls();
+            sendPendingCalls();
+        });
+    }
+}
+
+void DBusCallQueue::completeFinishedCalls() {
+    while (!callList.isEmpty() && callList.first()->isFinished) {
+        auto* call = callList.takeFirst();
+        if (call->callback) {
+            call->callback(call->reply);
+        }
+        delete call;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+
+#include <QDBusMessage>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+
+#include "RefreshStats.hpp"
+
+class QDBusPendingCallWatcher;
+
+class DBusCallQueue : public QObject {
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(const QDBusMessage& reply)>;
+
+    DBusCallQueue(int maxInFlightCalls = 8, QObject* parent = nullptr);
+    ~DBusCallQueue() override;
+
+    // Sends the call asynchronously, keeping at most maxInFlightCalls
+    // of them in flight; callbacks are invoked in the enqueuing order
+    void enqueue(const QDBusMessage& message, Callback callback = nullptr);
+
+    void setStats(RefreshStats* stats);
+
+private:
+    class Call {
+    public:
+        QDBusMessage message;
+        Callback callback;
+        QDBusPendingCallWatcher* watcher = nullptr;
+        QElapsedTimer elapsedTimer;
+        bool isFinished = false;
+        QDBusMessage reply;
+    };
+
+    int maxInFlightCalls;
+    int inFlightCallCount;
+    QList<Call*> callList;
+    RefreshStats* stats;
+
+    void sendPendingCalls();
+    void completeFinishedCalls();
+};
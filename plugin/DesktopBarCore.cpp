@@ -0,0 +1,915 @@
+#include "DesktopBarCore.hpp"
+
+#include <QDBusConnection>
+#include <QScopedPointer>
+#include <QTimer>
+#include <QWeakPointer>
+
+#include <KGlobalAccel>
+
+#include "KWinBackend.hpp"
+#include "TraceRecorder.hpp"
+
+QSharedPointer<DesktopBarCore> DesktopBarCore::acquire() {
+    static QWeakPointer<DesktopBarCore> instance;
+
+    auto core = instance.toStrongRef();
+    if (!core) {
+        auto* backend = new KWinBackend;
+
+        // Records what the window system reports to the given file,
+        // to be replayed with virtualdesktopbar-replay
+        QString tracePath = QString::fromLocal8Bit(qgetenv("VIRTUAL_DESKTOP_BAR_TRACE"));
+        if (!tracePath.isEmpty()) {
+            new TraceRecorder(backend, tracePath, backend);
+        }
+
+        core = QSharedPointer<DesktopBarCore>(new DesktopBarCore(backend), &QObject::deleteLater);
+        backend->setParent(core.data());
+        core->setUpGlobalKeyboardShortcuts();
+        instance = core;
+
+        // Lets the stats be dumped to the log with
+        // qdbus org.kde.plasmashell /VirtualDesktopBar/Stats dump,
+        // replacing the ones of a previous core that is still to be deleted
+        QString statsPath("/VirtualDesktopBar/Stats");
+        auto bus = QDBusConnection::sessionBus();
+        bus.unregisterObject(statsPath);
+        if (!bus.registerObject(statsPath, core->getStats(), QDBusConnection::ExportAllInvokables)) {
+            qWarning("Could not register the stats on the session bus");
+        }
+    }
+    return core;
+}
+
+DesktopBarCore::DesktopBarCore(WindowSystemBackend* backend, QObject* parent) : QObject(parent),
+        backend(backend),
+        desktopTable(backend),
+        nameReconciler(backend, &desktopTable),
+        windowCache(backend),
+        windowIndexDirty(true),
+        windowScanner(nullptr),
+        isPopulatingWindows(false),
+        stats(new RefreshStats(this)),
+        transactionNumberOfDesktops(0),
+        transactionCurrentDesktop(0),
+        currentDesktopNumber(backend->currentDesktop()),
+        mostRecentDesktopNumber(currentDesktopNumber),
+        actionCollection(nullptr) {
+
+    backend->setStats(stats);
+    windowCache.setStats(stats);
+    windowIndex.setStats(stats);
+    refreshScheduler.setStats(stats);
+
+    desktopTable.populate();
+    stats->markStartupPhase(RefreshStats::DesktopTablePhase);
+
+    // Without a thread-safe way to fetch windows, they are fetched on the GUI thread
+    auto windowFetchFunction = backend->createWindowFetchFunction();
+    if (windowFetchFunction) {
+        windowScanner = new WindowScanner(windowFetchFunction, this);
+    }
+
+    refreshScheduler.suspend();
+    QTimer::singleShot(0, this, [&] {
+        populateWindows();
+    });
+
+    transactionTimer.setSingleShot(true);
+    transactionTimer.setInterval(1000);
+    QObject::connect(&transactionTimer, &QTimer::timeout, this, [&] {
+        endTransaction();
+    });
+
+    setUpSignals();
+}
+
+void DesktopBarCore::setSettings(QObject* view, const Settings& viewSettings) {
+    for (auto& item : viewSettingsList) {
+        if (item.first == view) {
+            item.second = viewSettings;
+            combineSettings();
+            return;
+        }
+    }
+
+    viewSettingsList << qMakePair(view, viewSettings);
+    combineSettings();
+}
+
+void DesktopBarCore::removeSettings(QObject* view) {
+    for (int i = 0; i < viewSettingsList.length(); i++) {
+        if (viewSettingsList[i].first == view) {
+            viewSettingsList.removeAt(i);
+            combineSettings();
+            return;
+        }
+    }
+}
+
+bool DesktopBarCore::isPrimaryView(QObject* view) const {
+    return !viewSettingsList.isEmpty() && viewSettingsList.first().first == view;
+}
+
+void DesktopBarCore::combineSettings() {
+    Settings combinedSettings;
+    combinedSettings.coalescingInterval = -1;
+
+    for (auto& item : viewSettingsList) {
+        auto& viewSettings = item.second;
+        if (combinedSettings.emptyDesktopsRenameAs.isEmpty()) {
+            combinedSettings.emptyDesktopsRenameAs = viewSettings.emptyDesktopsRenameAs;
+        }
+        if (combinedSettings.addingDesktopsExecuteCommand.isEmpty()) {
+            combinedSettings.addingDesktopsExecuteCommand = viewSettings.addingDesktopsExecuteCommand;
+        }
+        if (combinedSettings.windowNameRules.isEmpty()) {
+            combinedSettings.windowNameRules = viewSettings.windowNameRules;
+        }
+        if (viewSettings.dynamicDesktopsEnable) {
+            combinedSettings.dynamicDesktopsEnable = true;
+        }
+        combinedSettings.dynamicDesktopsRemovalDelay = qMax(combinedSettings.dynamicDesktopsRemovalDelay,
+                                                            viewSettings.dynamicDesktopsRemovalDelay);
+        combinedSettings.dynamicDesktopsMinimumInterval = qMax(combinedSettings.dynamicDesktopsMinimumInterval,
+                                                               viewSettings.dynamicDesktopsMinimumInterval);
+        if (viewSettings.windowNamesShow) {
+            combinedSettings.windowNamesShow = true;
+        }
+        if (viewSettings.screenFilterEnable) {
+            combinedSettings.screenFilterEnable = true;
+        }
+        if (combinedSettings.coalescingInterval < 0 ||
+            viewSettings.coalescingInterval < combinedSettings.coalescingInterval) {
+            combinedSettings.coalescingInterval = viewSettings.coalescingInterval;
+        }
+    }
+
+    combinedSettings.coalescingInterval = qMax(0, combinedSettings.coalescingInterval);
+    refreshScheduler.setInterval(combinedSettings.coalescingInterval);
+
+    dynamicDesktopPolicy.setEnabled(combinedSettings.dynamicDesktopsEnable);
+    dynamicDesktopPolicy.setRemovalDelay(combinedSettings.dynamicDesktopsRemovalDelay);
+    dynamicDesktopPolicy.setMinimumInterval(combinedSettings.dynamicDesktopsMinimumInterval);
+
+    // Changes that were filtered out while nothing showed them may be pending
+    bool isPolicyChanged = combinedSettings.emptyDesktopsRenameAs != settings.emptyDesktopsRenameAs ||
+                           combinedSettings.dynamicDesktopsEnable != settings.dynamicDesktopsEnable ||
+                           (combinedSettings.windowNamesShow && !settings.windowNamesShow) ||
+                           (combinedSettings.screenFilterEnable && !settings.screenFilterEnable);
+
+    settings = combinedSettings;
+
+    if (windowScanner) {
+        windowScanner->setNameRules(settings.windowNameRules);
+    }
+    if (windowCache.setNameRules(settings.windowNameRules)) {
+        windowIndexDirty = true;
+        isPolicyChanged = true;
+    }
+
+    if (isPolicyChanged) {
+        refreshScheduler.schedule(RefreshScheduler::ConfigurationChange);
+    }
+}
+
+void DesktopBarCore::schedule(RefreshScheduler::Changes changes) {
+    refreshScheduler.schedule(changes);
+}
+
+bool DesktopBarCore::isIdle() {
+    return !windowScanner || windowScanner->isIdle();
+}
+
+WindowSystemBackend* DesktopBarCore::getBackend() const {
+    return backend;
+}
+
+RefreshStats* DesktopBarCore::getStats() const {
+    return stats;
+}
+
+const DesktopTable& DesktopBarCore::getDesktopTable() const {
+    return desktopTable;
+}
+
+void DesktopBarCore::showDesktop(int number) {
+    backend->setCurrentDesktop(number);
+}
+
+void DesktopBarCore::addDesktop() {
+    backend->setNumberOfDesktops(backend->numberOfDesktops() + 1);
+
+    if (!settings.addingDesktopsExecuteCommand.isEmpty()) {
+        QString command = "(" + settings.addingDesktopsExecuteCommand + ") &";
+        QTimer::singleShot(100, [=] {
+            system(command.toStdString().c_str());
+        });
+    }
+}
+
+void DesktopBarCore::removeDesktops(QList<int> numbers) {
+    QStringList idList;
+    for (int number : numbers) {
+        if (auto* desktopInfo = desktopTable.find(number)) {
+            idList << desktopInfo->id;
+        }
+    }
+
+    if (idList.isEmpty()) {
+        return;
+    }
+
+    // KWin removes desktops by their ids, so the calls can be pipelined
+    // and the desktops that failed to be removed are handled together
+    auto failedIdList = QSharedPointer<QStringList>::create();
+    auto remainingCallCount = QSharedPointer<int>::create(idList.length());
+
+    for (auto& id : idList) {
+        backend->removeDesktop(id, [this, id, failedIdList, remainingCallCount](bool isSuccessful) {
+            if (!isSuccessful) {
+                *failedIdList << id;
+            }
+
+            if (--*remainingCallCount == 0 && !failedIdList->isEmpty()) {
+                QList<int> failedNumberList;
+                for (auto& failedId : *failedIdList) {
+                    if (auto* desktopInfo = desktopTable.find(failedId)) {
+                        failedNumberList << desktopInfo->number;
+                    }
+                }
+                removeDesktopsFallback(failedNumberList);
+            }
+        });
+    }
+}
+
+void DesktopBarCore::removeDesktopsFallback(QList<int> numbers) {
+    int numberOfDesktops = backend->numberOfDesktops();
+
+    QVector<bool> isRemovedList(numberOfDesktops + 1, false);
+    for (int number : numbers) {
+        if (number >= 1 && number <= numberOfDesktops) {
+            isRemovedList[number] = true;
+        }
+    }
+
+    // Computing the final number of every desktop once, windows of removed
+    // desktops end up on the desktop which takes the place of theirs
+    QVector<int> newNumberList(numberOfDesktops + 1, 0);
+    QStringList newNameList;
+    int removedCount = 0;
+    for (int i = 1; i <= numberOfDesktops; i++) {
+        if (isRemovedList[i]) {
+            removedCount++;
+            newNumberList[i] = i - removedCount + 1;
+        } else {
+            newNumberList[i] = i - removedCount;
+            newNameList << backend->desktopName(i);
+        }
+    }
+
+    int newNumberOfDesktops = numberOfDesktops - removedCount;
+    if (removedCount == 0 || newNumberOfDesktops < 1) {
+        return;
+    }
+
+    beginTransaction();
+
+    X11Batch batch;
+    auto& index = getWindowIndex();
+
+    for (int i = 1; i <= numberOfDesktops; i++) {
+        int newNumber = qMin(newNumberList[i], newNumberOfDesktops);
+        if (newNumber == i) {
+            continue;
+        }
+
+        for (int j = 0; j < index.count(i); j++) {
+            if (index.at(i, j).desktopNumber == i) {
+                batch.moveWindow(index.at(i, j).id, newNumber);
+            }
+        }
+    }
+
+    for (int i = 1; i <= newNumberOfDesktops; i++) {
+        if (backend->desktopName(i) != newNameList[i - 1]) {
+            batch.setDesktopNames(newNameList);
+            break;
+        }
+    }
+
+    batch.setNumberOfDesktops(newNumberOfDesktops);
+    desktopTable.expectRemoval(numbers);
+    commit(batch);
+
+    updateTransaction();
+}
+
+void DesktopBarCore::renameDesktop(int number, QString name) {
+    if (auto* desktopInfo = desktopTable.find(number)) {
+        nameReconciler.reconcile({ { desktopInfo->id, name } });
+    }
+}
+
+void DesktopBarCore::moveDesktop(int from, int to) {
+    int numberOfDesktops = desktopTable.count();
+    if (from == to) {
+        return;
+    }
+    if (from < 1 || from > numberOfDesktops) {
+        return;
+    }
+    if (to < 1 || to > numberOfDesktops) {
+        return;
+    }
+
+    QList<int> permutation;
+    for (int i = 1; i <= numberOfDesktops; i++) {
+        permutation << i;
+    }
+    permutation.move(from - 1, to - 1);
+
+    applyPermutation(permutation);
+}
+
+void DesktopBarCore::applyPermutation(QList<int> permutation) {
+    int numberOfDesktops = desktopTable.count();
+    if (permutation.length() != numberOfDesktops) {
+        return;
+    }
+
+    // The permutation lists current desktop numbers in their new order
+    QVector<int> newNumberList(numberOfDesktops + 1, 0);
+    for (int i = 0; i < permutation.length(); i++) {
+        int number = permutation[i];
+        if (number < 1 || number > numberOfDesktops || newNumberList[number] != 0) {
+            return;
+        }
+        newNumberList[number] = i + 1;
+    }
+
+    if (transactionTimer.isActive()) {
+        if (queuedPermutation.length() == permutation.length()) {
+            QList<int> combinedPermutation;
+            for (int number : permutation) {
+                combinedPermutation << queuedPermutation[number - 1];
+            }
+            queuedPermutation = combinedPermutation;
+        } else {
+            queuedPermutation = permutation;
+        }
+        return;
+    }
+
+    beginTransaction();
+
+    X11Batch batch;
+    auto& index = getWindowIndex();
+
+    for (int number = 1; number <= numberOfDesktops; number++) {
+        int newNumber = newNumberList[number];
+        if (newNumber == number) {
+            continue;
+        }
+
+        for (int j = 0; j < index.count(number); j++) {
+            if (index.at(number, j).desktopNumber == number) {
+                batch.moveWindow(index.at(number, j).id, newNumber);
+            }
+        }
+    }
+
+    int currentDesktop = backend->currentDesktop();
+    if (currentDesktop >= 1 && currentDesktop <= numberOfDesktops &&
+        newNumberList[currentDesktop] != currentDesktop) {
+        batch.setCurrentDesktop(newNumberList[currentDesktop]);
+    }
+
+    commit(batch);
+
+    // Desktops themselves stay in place, only their windows and names move
+    QHash<QString, QString> targetNameHash;
+    for (int i = 0; i < permutation.length(); i++) {
+        targetNameHash.insert(desktopTable.find(i + 1)->id, desktopTable.find(permutation[i])->name);
+    }
+    nameReconciler.reconcile(targetNameHash);
+
+    updateTransaction();
+}
+
+void DesktopBarCore::beginTransaction() {
+    if (!transactionTimer.isActive()) {
+        refreshScheduler.suspend();
+    }
+    transactionTimer.start();
+}
+
+void DesktopBarCore::commit(X11Batch& batch) {
+    for (auto& windowMove : batch.getWindowMoveList()) {
+        auto* record = windowCache.find(windowMove.first);
+        if (record && record->desktopNumber != windowMove.second) {
+            transactionWindowSet << windowMove.first;
+        }
+    }
+
+    if (batch.getNumberOfDesktops() > 0 && batch.getNumberOfDesktops() != backend->numberOfDesktops()) {
+        transactionNumberOfDesktops = batch.getNumberOfDesktops();
+    }
+    if (batch.getCurrentDesktopNumber() > 0 && batch.getCurrentDesktopNumber() != backend->currentDesktop()) {
+        transactionCurrentDesktop = batch.getCurrentDesktopNumber();
+    }
+
+    backend->commit(batch);
+    windowIndexDirty = true;
+}
+
+void DesktopBarCore::updateTransaction() {
+    if (!transactionTimer.isActive()) {
+        return;
+    }
+
+    if (transactionWindowSet.isEmpty() &&
+        transactionNumberOfDesktops == 0 &&
+        transactionCurrentDesktop == 0 &&
+        !nameReconciler.isPending()) {
+        endTransaction();
+    }
+}
+
+void DesktopBarCore::endTransaction() {
+    transactionTimer.stop();
+    transactionWindowSet.clear();
+    transactionNumberOfDesktops = 0;
+    transactionCurrentDesktop = 0;
+    refreshScheduler.resume();
+
+    if (!queuedPermutation.isEmpty()) {
+        QList<int> permutation = queuedPermutation;
+        queuedPermutation.clear();
+        applyPermutation(permutation);
+    }
+}
+
+void DesktopBarCore::setUpSignals() {
+    QObject::connect(backend, &WindowSystemBackend::currentDesktopChanged, this, [&](int number) {
+        updateLocalDesktopNumbers();
+        refreshScheduler.schedule(RefreshScheduler::CurrentDesktopChange);
+
+        if (number == transactionCurrentDesktop) {
+            transactionCurrentDesktop = 0;
+            updateTransaction();
+        }
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::numberOfDesktopsChanged, this, [&](int numberOfDesktops) {
+        windowIndexDirty = true;
+        refreshScheduler.schedule(RefreshScheduler::DesktopCountChange);
+
+        if (numberOfDesktops == transactionNumberOfDesktops) {
+            transactionNumberOfDesktops = 0;
+            updateTransaction();
+        }
+    });
+
+    QObject::connect(&desktopTable, &DesktopTable::desktopCountChanged, this, [&] {
+        nameReconciler.acknowledge();
+        refreshScheduler.schedule(RefreshScheduler::DesktopCountChange);
+    });
+
+    // Names changed by the reconciler are shown once all of them are there
+    QObject::connect(&desktopTable, &DesktopTable::desktopNamesChanged, this, [&] {
+        if (nameReconciler.acknowledge()) {
+            refreshScheduler.schedule(RefreshScheduler::DesktopNamesChange);
+        }
+    });
+
+    QObject::connect(&nameReconciler, &DesktopNameReconciler::settled, this, [&] {
+        refreshScheduler.schedule(RefreshScheduler::DesktopNamesChange);
+        updateTransaction();
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::windowChanged, this, [&](WId id, NET::Properties properties, NET::Properties2 properties2) {
+        if (stats) {
+            stats->increment(RefreshStats::WindowEventCounter);
+        }
+
+        if (!windowScanner) {
+            handleWindowChanges(id, properties, windowCache.updateWindow(id, properties, properties2));
+            return;
+        }
+
+        // Windows not known yet are added with all of their properties
+        auto fetchedProperties = WindowCache::getFetchedProperties(properties);
+        if (!windowCache.find(id) && !pendingAddedWindowSet.contains(id)) {
+            pendingAddedWindowSet << id;
+            fetchedProperties = WindowCache::cachedProperties;
+        }
+
+        if (fetchedProperties) {
+            windowScanner->request(id, fetchedProperties);
+        } else if (stats) {
+            stats->increment(RefreshStats::FilteredEventCounter);
+        }
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::windowAdded, this, [&](WId id) {
+        if (windowScanner) {
+            pendingAddedWindowSet << id;
+            windowScanner->request(id, WindowCache::cachedProperties);
+            return;
+        }
+
+        windowCache.addWindow(id);
+        if (auto* record = windowCache.find(id)) {
+            windowIndexDirty = true;
+            handleWindowChanges(id, WindowCache::cachedProperties, record->isSkipped() ?
+                                                                   WindowCache::NoChange : WindowCache::VisibilityChange);
+        }
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::windowRemoved, this, [&](WId id) {
+        if (windowScanner) {
+            windowScanner->cancel(id);
+            pendingAddedWindowSet.remove(id);
+
+            // No scan may come anymore if all the windows awaited are gone
+            if (isPopulatingWindows && pendingAddedWindowSet.isEmpty()) {
+                finishPopulatingWindows();
+            }
+        }
+
+        // Closing a shown window may leave its desktop empty
+        auto* record = windowCache.find(id);
+        if (record && !record->isSkipped()) {
+            refreshScheduler.schedule(RefreshScheduler::WindowStateChange);
+        }
+
+        windowCache.removeWindow(id);
+        windowIndexDirty = true;
+
+        if (transactionWindowSet.remove(id)) {
+            updateTransaction();
+        }
+    });
+
+    if (windowScanner) {
+        QObject::connect(windowScanner, &WindowScanner::snapshotPublished, this, [&] {
+            applyWindowScan();
+        });
+    }
+
+    QObject::connect(backend, &WindowSystemBackend::stackingOrderChanged, this, [&] {
+        windowIndexDirty = true;
+
+        // Labels showing the active window's name depend on the topmost windows,
+        // which are told apart by screen only when building the snapshot
+        if (settings.windowNamesShow && (settings.screenFilterEnable || updateTopWindows())) {
+            refreshScheduler.schedule(RefreshScheduler::WindowStateChange);
+        }
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::screensChanged, this, [&] {
+        windowIndexDirty = true;
+        refreshScheduler.schedule(RefreshScheduler::ScreenChange);
+    });
+
+    QObject::connect(&refreshScheduler, &RefreshScheduler::triggered, this, [&](RefreshScheduler::Changes changes) {
+        processChanges(changes);
+    });
+
+    QObject::connect(&dynamicDesktopPolicy, &DynamicDesktopPolicy::addDesktopRequested, this, [&] {
+        addDesktop();
+    });
+
+    QObject::connect(&dynamicDesktopPolicy, &DynamicDesktopPolicy::removeDesktopsRequested, this, [&](const QStringList& idList) {
+        QList<int> numbers;
+        for (auto& id : idList) {
+            if (auto* desktopInfo = desktopTable.find(id)) {
+                numbers << desktopInfo->number;
+            }
+        }
+        removeDesktops(numbers);
+    });
+}
+
+void DesktopBarCore::handleWindowChanges(WId id, NET::Properties properties, WindowCache::Changes changes) {
+    if (changes) {
+        windowIndexDirty = true;
+    }
+
+    // Names and geometry are kept up to date in the index,
+    // but refresh the bar only if some applet displays them
+    auto shownChanges = WindowCache::DesktopChange |
+                        WindowCache::VisibilityChange |
+                        WindowCache::UrgencyChange;
+    if (settings.windowNamesShow) {
+        shownChanges |= WindowCache::NameChange;
+    }
+    if (settings.screenFilterEnable) {
+        shownChanges |= WindowCache::GeometryChange;
+    }
+
+    if (changes & shownChanges) {
+        refreshScheduler.schedule(RefreshScheduler::WindowStateChange);
+    } else if (stats) {
+        stats->increment(RefreshStats::FilteredEventCounter);
+    }
+
+    if ((properties & NET::WMDesktop) && transactionWindowSet.remove(id)) {
+        updateTransaction();
+    }
+}
+
+bool DesktopBarCore::updateTopWindows() {
+    int numberOfDesktops = backend->numberOfDesktops();
+    QVector<WId> newTopWindowList(numberOfDesktops + 1, 0);
+    int remainingCount = numberOfDesktops;
+
+    auto stackingOrder = backend->stackingOrder();
+    for (int i = stackingOrder.length() - 1; i >= 0 && remainingCount > 0; i--) {
+        auto* record = windowCache.find(stackingOrder[i]);
+        if (!record || record->isSkipped()) {
+            continue;
+        }
+
+        int desktopNumber = record->desktopNumber;
+        bool isSticky = desktopNumber == NET::OnAllDesktops;
+        if (!isSticky && (desktopNumber < 1 || desktopNumber > numberOfDesktops)) {
+            continue;
+        }
+
+        for (int n = isSticky ? 1 : desktopNumber; n <= (isSticky ? numberOfDesktops : desktopNumber); n++) {
+            if (!newTopWindowList[n]) {
+                newTopWindowList[n] = record->id;
+                remainingCount--;
+            }
+        }
+    }
+
+    bool isChanged = newTopWindowList != topWindowList;
+    topWindowList = newTopWindowList;
+    return isChanged;
+}
+
+void DesktopBarCore::applyWindowScan() {
+    QScopedPointer<const WindowScanner::Snapshot> snapshot(windowScanner->takeSnapshot());
+    if (!snapshot) {
+        return;
+    }
+
+    // Fetches made on the worker thread count like the ones made here
+    for (qint64 nsecs : snapshot->fetchNsecsList) {
+        stats->addSample(RefreshStats::WindowFetchStage, nsecs);
+    }
+    for (qint64 nsecs : snapshot->parseNsecsList) {
+        stats->addSample(RefreshStats::TitleParseStage, nsecs);
+    }
+    stats->increment(RefreshStats::XRoundTripCounter, snapshot->fetchNsecsList.length());
+
+    auto& resultHash = snapshot->resultHash;
+    for (auto it = resultHash.constBegin(); it != resultHash.constEnd(); it++) {
+        WId id = it.key();
+        auto& result = it.value();
+
+        if (pendingAddedWindowSet.remove(id)) {
+            if (result.isValid) {
+                windowCache.insertWindow(id, result.windowProperties);
+                windowIndexDirty = true;
+                handleWindowChanges(id, result.properties, windowCache.find(id)->isSkipped() ?
+                                                           WindowCache::NoChange : WindowCache::VisibilityChange);
+            }
+            continue;
+        }
+
+        // Windows removed while being scanned are ignored
+        auto* record = windowCache.find(id);
+        if (!record) {
+            continue;
+        }
+
+        if (!result.isValid) {
+            bool wasSkipped = record->isSkipped();
+            windowCache.removeWindow(id);
+            handleWindowChanges(id, result.properties, wasSkipped ?
+                                                       WindowCache::NoChange : WindowCache::VisibilityChange);
+            continue;
+        }
+
+        handleWindowChanges(id, result.properties,
+                            windowCache.applyWindow(id, result.properties, result.windowProperties));
+    }
+
+    if (isPopulatingWindows && pendingAddedWindowSet.isEmpty()) {
+        finishPopulatingWindows();
+    }
+}
+
+void DesktopBarCore::populateWindows() {
+    if (!windowScanner) {
+        windowCache.populate();
+        finishPopulatingWindows();
+        return;
+    }
+
+    // Windows reported added in the meantime are already on their way
+    isPopulatingWindows = true;
+    for (WId id : backend->windows()) {
+        if (!windowCache.find(id) && !pendingAddedWindowSet.contains(id)) {
+            pendingAddedWindowSet << id;
+            windowScanner->request(id, WindowCache::cachedProperties);
+        }
+    }
+
+    if (pendingAddedWindowSet.isEmpty()) {
+        finishPopulatingWindows();
+    }
+}
+
+void DesktopBarCore::finishPopulatingWindows() {
+    isPopulatingWindows = false;
+    windowIndexDirty = true;
+    stats->markStartupPhase(RefreshStats::WindowScanPhase);
+
+    refreshScheduler.schedule(RefreshScheduler::WindowStateChange);
+    refreshScheduler.resume();
+}
+
+void DesktopBarCore::setUpGlobalKeyboardShortcuts() {
+    QString prefix = "Virtual Desktop Bar - ";
+    actionCollection = new KActionCollection(this, QStringLiteral("kwin"));
+
+    actionSwitchToRecentDesktop = actionCollection->addAction(QStringLiteral("switchToRecentDesktop"));
+    actionSwitchToRecentDesktop->setText(prefix + "Switch to Recent Desktop");
+    QObject::connect(actionSwitchToRecentDesktop, &QAction::triggered, this, [&] {
+        showDesktop(mostRecentDesktopNumber);
+    });
+    pendingShortcutActionList << actionSwitchToRecentDesktop;
+
+    actionAddDesktop = actionCollection->addAction(QStringLiteral("addDesktop"));
+    actionAddDesktop->setText(prefix + "Add Desktop");
+    QObject::connect(actionAddDesktop, &QAction::triggered, this, [&] {
+        if (!settings.dynamicDesktopsEnable) {
+            addDesktop();
+        }
+    });
+    pendingShortcutActionList << actionAddDesktop;
+
+    actionRemoveLastDesktop = actionCollection->addAction(QStringLiteral("removeLastDesktop"));
+    actionRemoveLastDesktop->setText(prefix + "Remove Last Desktop");
+    QObject::connect(actionRemoveLastDesktop, &QAction::triggered, this, [&] {
+        if (!settings.dynamicDesktopsEnable) {
+            removeDesktops({ backend->numberOfDesktops() });
+        }
+    });
+    pendingShortcutActionList << actionRemoveLastDesktop;
+
+    actionRemoveCurrentDesktop = actionCollection->addAction(QStringLiteral("removeCurrentDesktop"));
+    actionRemoveCurrentDesktop->setText(prefix + "Remove Current Desktop");
+    QObject::connect(actionRemoveCurrentDesktop, &QAction::triggered, this, [&] {
+        if (!settings.dynamicDesktopsEnable) {
+            removeDesktops({ backend->currentDesktop() });
+        }
+    });
+    pendingShortcutActionList << actionRemoveCurrentDesktop;
+
+    actionRenameCurrentDesktop = actionCollection->addAction(QStringLiteral("renameCurrentDesktop"));
+    actionRenameCurrentDesktop->setText(prefix + "Rename Current Desktop");
+    QObject::connect(actionRenameCurrentDesktop, &QAction::triggered, this, [&] {
+        emit requestRenameCurrentDesktop();
+    });
+    pendingShortcutActionList << actionRenameCurrentDesktop;
+
+    actionMoveCurrentDesktopToLeft = actionCollection->addAction(QStringLiteral("moveCurrentDesktopToLeft"));
+    actionMoveCurrentDesktopToLeft->setText(prefix + "Move Current Desktop to Left");
+    QObject::connect(actionMoveCurrentDesktopToLeft, &QAction::triggered, this, [&] {
+        moveDesktop(backend->currentDesktop(),
+                    backend->currentDesktop() - 1);
+    });
+    pendingShortcutActionList << actionMoveCurrentDesktopToLeft;
+
+    actionMoveCurrentDesktopToRight = actionCollection->addAction(QStringLiteral("moveCurrentDesktopToRight"));
+    actionMoveCurrentDesktopToRight->setText(prefix + "Move Current Desktop to Right");
+    QObject::connect(actionMoveCurrentDesktopToRight, &QAction::triggered, this, [&] {
+        moveDesktop(backend->currentDesktop(),
+                    backend->currentDesktop() + 1);
+    });
+    pendingShortcutActionList << actionMoveCurrentDesktopToRight;
+
+    QTimer::singleShot(0, this, [&] {
+        registerPendingShortcuts();
+    });
+}
+
+void DesktopBarCore::registerPendingShortcuts() {
+    if (pendingShortcutActionList.isEmpty()) {
+        stats->markStartupPhase(RefreshStats::ShortcutsPhase);
+        return;
+    }
+
+    KGlobalAccel::setGlobalShortcut(pendingShortcutActionList.takeFirst(), QKeySequence());
+
+    QTimer::singleShot(0, this, [&] {
+        registerPendingShortcuts();
+    });
+}
+
+void DesktopBarCore::processChanges(RefreshScheduler::Changes changes) {
+    RefreshStats::Timer timer(stats, RefreshStats::RefreshStage);
+    stats->increment(RefreshStats::RefreshCounter);
+
+    if (changes & (RefreshScheduler::DesktopCountChange |
+                   RefreshScheduler::WindowStateChange |
+                   RefreshScheduler::ConfigurationChange)) {
+        // Both lists come from the same window index, built once per pass
+        updateDynamicDesktops(getEmptyDesktopNumberList(false));
+        tryRenameEmptyDesktops(getEmptyDesktopNumberList());
+    }
+
+    emit refreshed(changes);
+    stats->notify();
+}
+
+QList<int> DesktopBarCore::getEmptyDesktopNumberList(bool noCheating) {
+    QList<int> emptyDesktopNumberList;
+
+    auto& index = getWindowIndex();
+
+    for (int i = 1; i <= backend->numberOfDesktops(); i++) {
+        bool isConsideredEmpty = noCheating ? index.count(i) == 0 : !index.hasOwnWindows(i);
+        if (isConsideredEmpty) {
+            emptyDesktopNumberList << i;
+        }
+    }
+
+    return emptyDesktopNumberList;
+}
+
+const WindowIndex& DesktopBarCore::getWindowIndex() {
+    if (windowIndexDirty) {
+        QList<QRect> screenRectList;
+        for (auto& screenInfo : backend->screens()) {
+            screenRectList << screenInfo.geometry;
+        }
+
+        windowIndexDirty = false;
+        windowIndex.rebuild(windowCache, backend->stackingOrder(),
+                            backend->numberOfDesktops(), screenRectList);
+    }
+    return windowIndex;
+}
+
+int DesktopBarCore::getScreenIndex(const QString& screenName) const {
+    auto screenInfoList = backend->screens();
+    for (int i = 0; i < screenInfoList.length(); i++) {
+        if (screenInfoList[i].name == screenName) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+void DesktopBarCore::updateDynamicDesktops(const QList<int>& emptyDesktopNumberList) {
+    if (!settings.dynamicDesktopsEnable) {
+        return;
+    }
+
+    // Desktops are told apart by ids, as numbers shift when some are removed
+    QStringList desktopIdList;
+    for (auto& desktopInfo : desktopTable.getDesktopInfoList()) {
+        desktopIdList << desktopInfo.id;
+    }
+
+    QSet<QString> emptyDesktopIdSet;
+    for (int number : emptyDesktopNumberList) {
+        if (auto* desktopInfo = desktopTable.find(number)) {
+            emptyDesktopIdSet << desktopInfo->id;
+        }
+    }
+
+    dynamicDesktopPolicy.update(desktopIdList, emptyDesktopIdSet);
+}
+
+void DesktopBarCore::tryRenameEmptyDesktops(const QList<int>& emptyDesktopNumberList) {
+    if (settings.emptyDesktopsRenameAs.isEmpty()) {
+        return;
+    }
+
+    // Desktops already named so are left alone by the reconciler
+    QHash<QString, QString> targetNameHash;
+    for (int desktopNumber : emptyDesktopNumberList) {
+        if (auto* desktopInfo = desktopTable.find(desktopNumber)) {
+            targetNameHash.insert(desktopInfo->id, settings.emptyDesktopsRenameAs);
+        }
+    }
+    nameReconciler.reconcile(targetNameHash);
+}
+
+void DesktopBarCore::updateLocalDesktopNumbers() {
+    int n = backend->currentDesktop();
+    if (currentDesktopNumber != n) {
+        mostRecentDesktopNumber = currentDesktopNumber;
+    }
+    currentDesktopNumber = n;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <QAction>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include <KActionCollection>
+
+#include "DesktopInfo.hpp"
+#include "DesktopNameReconciler.hpp"
+#include "DesktopTable.hpp"
+#include "DynamicDesktopPolicy.hpp"
+#include "RefreshScheduler.hpp"
+#include "RefreshStats.hpp"
+#include "WindowCache.hpp"
+#include "WindowIndex.hpp"
+#include "WindowScanner.hpp"
+#include "WindowSystemBackend.hpp"
+#include "X11Batch.hpp"
+
+// State and behavior shared by all the applet instances in the process:
+// the window cache and index, the desktop list, requests to the window
+// manager, the dynamic desktops policy and the global keyboard shortcuts
+class DesktopBarCore : public QObject {
+    Q_OBJECT
+
+public:
+    class Settings {
+    public:
+        QString emptyDesktopsRenameAs;
+        QString addingDesktopsExecuteCommand;
+        QString windowNameRules;
+        bool dynamicDesktopsEnable = false;
+        int dynamicDesktopsRemovalDelay = 0;
+        int dynamicDesktopsMinimumInterval = 0;
+        bool windowNamesShow = false;
+        bool screenFilterEnable = false;
+        int coalescingInterval = 0;
+    };
+
+    // The process-wide instance, running against the real window system,
+    // created on first use and destroyed when the last applet is gone
+    static QSharedPointer<DesktopBarCore> acquire();
+
+    // Runs against the given backend,
+    // without registering any global keyboard shortcuts
+    DesktopBarCore(WindowSystemBackend* backend, QObject* parent = nullptr);
+
+    // Every applet instance has its own settings, which are combined:
+    // dynamic desktops are managed if any of the instances enables it,
+    // the first instance which sets a text, a command or rules decides them,
+    // and the shortest coalescing interval is used
+    void setSettings(QObject* view, const Settings& viewSettings);
+    void removeSettings(QObject* view);
+
+    // The instance which shows the rename popup for the global shortcut
+    bool isPrimaryView(QObject* view) const;
+
+    void schedule(RefreshScheduler::Changes changes);
+
+    // Whether no window scan is in flight on the worker thread
+    bool isIdle();
+
+    WindowSystemBackend* getBackend() const;
+    RefreshStats* getStats() const;
+    const DesktopTable& getDesktopTable() const;
+    const WindowIndex& getWindowIndex();
+    int getScreenIndex(const QString& screenName) const;
+
+    void showDesktop(int number);
+    void addDesktop();
+    void removeDesktops(QList<int> numbers);
+    void renameDesktop(int number, QString name);
+    void moveDesktop(int from, int to);
+    void applyPermutation(QList<int> permutation);
+
+signals:
+    // Emitted once per coalesced pass, after the dynamic desktops policy ran
+    void refreshed(RefreshScheduler::Changes changes);
+    void requestRenameCurrentDesktop();
+
+private:
+    WindowSystemBackend* backend;
+    DesktopTable desktopTable;
+
+    // All the renames go through it, so renaming a desktop to the name it
+    // already has costs nothing, and the name changes coming back from
+    // the window manager only cause a single refresh once all are there
+    DesktopNameReconciler nameReconciler;
+    WindowCache windowCache;
+    WindowIndex windowIndex;
+    bool windowIndexDirty;
+
+    // Scans windows on a worker thread if the backend allows it, windows
+    // reported added are only put into the cache once they are scanned
+    WindowScanner* windowScanner;
+    QSet<WId> pendingAddedWindowSet;
+    void applyWindowScan();
+    void handleWindowChanges(WId id, NET::Properties properties, WindowCache::Changes changes);
+
+    // Topmost shown window of every desktop as of the last stacking order
+    // change, returns whether any of them is different now
+    QVector<WId> topWindowList;
+    bool updateTopWindows();
+
+    // Windows are enumerated once the event loop runs, so the first snapshot
+    // only waits for the desktops. Refreshes are held back until then, as
+    // every desktop would look empty to the dynamic desktops and renaming.
+    // Set while the windows requested from the scanner are awaited
+    bool isPopulatingWindows;
+    void populateWindows();
+    void finishPopulatingWindows();
+
+    RefreshScheduler refreshScheduler;
+    RefreshStats* stats;
+
+    QList<QPair<QObject*, Settings>> viewSettingsList;
+    Settings settings;
+    void combineSettings();
+
+    void removeDesktopsFallback(QList<int> numbers);
+
+    // Requests sent together are applied by the window manager one by one,
+    // so refreshes are held back until all of them are reflected, or until
+    // the timeout if some of them never are, and a single pass runs after
+    void beginTransaction();
+    void commit(X11Batch& batch);
+    void updateTransaction();
+    void endTransaction();
+    QTimer transactionTimer;
+    QSet<WId> transactionWindowSet;
+    int transactionNumberOfDesktops;
+    int transactionCurrentDesktop;
+
+    // Moves are expressed in terms of the state the previous ones lead to,
+    // which the desktop table and the window cache only reflect once these
+    // are applied, so moves made in the meantime are combined into a single
+    // permutation applied when the transaction is over
+    QList<int> queuedPermutation;
+
+    void setUpSignals();
+    void setUpGlobalKeyboardShortcuts();
+
+    // Each registration is a blocking call to the global shortcut daemon,
+    // so shortcuts are registered one per event loop pass
+    QList<QAction*> pendingShortcutActionList;
+    void registerPendingShortcuts();
+
+    QList<int> getEmptyDesktopNumberList(bool noCheating = true);
+
+    DynamicDesktopPolicy dynamicDesktopPolicy;
+    void updateDynamicDesktops(const QList<int>& emptyDesktopNumberList);
+    void tryRenameEmptyDesktops(const QList<int>& emptyDesktopNumberList);
+    void processChanges(RefreshScheduler::Changes changes);
+
+    int currentDesktopNumber;
+    int mostRecentDesktopNumber;
+    void updateLocalDesktopNumbers();
+
+    KActionCollection* actionCollection;
+    QAction* actionSwitchToRecentDesktop;
+    QAction* actionAddDesktop;
+    QAction* actionRemoveLastDesktop;
+    QAction* actionRemoveCurrentDesktop;
+    QAction* actionRenameCurrentDesktop;
+    QAction* actionMoveCurrentDesktopToLeft;
+    QAction* actionMoveCurrentDesktopToRight;
+};
@@ -3,24 +3,14 @@
 #include <QDBusArgument>
 #include <QList>
 #include <QString>
-#include <QVariantMap>
 
+// A desktop as known to the window manager, what the applet shows
+// about it is kept in DesktopSnapshot
 class DesktopInfo {
 public:
-    // Basic info
     int number = 0;
     QString id = "";
     QString name = "";
-    bool isCurrent = false;
-
-    // Extra info
-    bool isEmpty = true;
-    bool isUrgent = false;
-    QString activeWindowName;
-    QList<QString> windowNameList;
-
-    // "Serializing" method
-    QVariantMap toQVariantMap();
 };
 
 const QDBusArgument& operator>>(const QDBusArgument& arg, DesktopInfo& desktopInfo);
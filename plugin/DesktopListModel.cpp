@@ -0,0 +1,254 @@
+#include "DesktopListModel.hpp"
+
+#include <utility>
+
+DesktopListModel::DesktopListModel(QObject* parent) : QAbstractListModel(parent),
+        isRemovalDeferred(false) {}
+
+int DesktopListModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : rowList.length();
+}
+
+QVariant DesktopListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rowList.length()) {
+        return QVariant();
+    }
+
+    auto& row = rowList[index.row()];
+
+    if (row.source == RemovedSource) {
+        auto& removedDesktop = removedDesktopList[row.index];
+        switch (role) {
+            case NumberRole:
+                return removedDesktop.number;
+            case IdRole:
+                return removedDesktop.id;
+            case NameRole:
+                return removedDesktop.name;
+            case IsCurrentRole:
+                return false;
+            case IsEmptyRole:
+                return removedDesktop.isEmpty;
+            case IsUrgentRole:
+                return removedDesktop.isUrgent;
+            case ActiveWindowNameRole:
+                return removedDesktop.activeWindowName;
+            case WindowCountRole:
+                return removedDesktop.windowCount;
+            case IsRemovedRole:
+                return true;
+        }
+        return QVariant();
+    }
+
+    auto& rowSnapshot = row.source == PreviousSource ? previousSnapshot : snapshot;
+    int i = row.index;
+
+    switch (role) {
+        case NumberRole:
+            return rowSnapshot.getNumber(i);
+        case IdRole:
+            return rowSnapshot.getId(i);
+        case NameRole:
+            return rowSnapshot.getName(i);
+        case IsCurrentRole:
+            return rowSnapshot.isCurrent(i);
+        case IsEmptyRole:
+            return rowSnapshot.isEmpty(i);
+        case IsUrgentRole:
+            return rowSnapshot.isUrgent(i);
+        case ActiveWindowNameRole:
+            return rowSnapshot.getActiveWindowName(i);
+        case WindowCountRole:
+            return rowSnapshot.getWindowCount(i);
+        case IsRemovedRole:
+            return false;
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> DesktopListModel::roleNames() const {
+    QHash<int, QByteArray> roles;
+    roles.insert(NumberRole, "number");
+    roles.insert(IdRole, "id");
+    roles.insert(NameRole, "name");
+    roles.insert(IsCurrentRole, "isCurrent");
+    roles.insert(IsEmptyRole, "isEmpty");
+    roles.insert(IsUrgentRole, "isUrgent");
+    roles.insert(ActiveWindowNameRole, "activeWindowName");
+    roles.insert(WindowCountRole, "windowCount");
+    roles.insert(IsRemovedRole, "isRemoved");
+    return roles;
+}
+
+void DesktopListModel::update(DesktopSnapshot&& newSnapshot) {
+    previousSnapshot = std::move(snapshot);
+    snapshot = std::move(newSnapshot);
+
+    for (auto& row : rowList) {
+        if (row.source == CurrentSource) {
+            row.source = PreviousSource;
+        }
+    }
+
+    if (isRemovalDeferred) {
+        // Rows of desktops that are gone stay where they are until released
+        for (int i = 0; i < rowList.length(); i++) {
+            auto& row = rowList[i];
+            if (row.source != PreviousSource || snapshot.indexOf(getId(row)) >= 0) {
+                continue;
+            }
+
+            int j = row.index;
+            removedDesktopList << RemovedDesktop{ previousSnapshot.getNumber(j), previousSnapshot.getId(j),
+                                                  previousSnapshot.getName(j), previousSnapshot.isEmpty(j),
+                                                  previousSnapshot.isUrgent(j), previousSnapshot.getActiveWindowName(j),
+                                                  previousSnapshot.getWindowCount(j) };
+            bool wasCurrent = previousSnapshot.isCurrent(j);
+            row = Row{ RemovedSource, removedDesktopList.length() - 1 };
+
+            QVector<int> changedRoles = { IsRemovedRole };
+            if (wasCurrent) {
+                changedRoles << IsCurrentRole;
+            }
+            emit dataChanged(index(i), index(i), changedRoles);
+        }
+    } else {
+        // Removing rows of desktops that are gone, in contiguous ranges
+        auto isGone = [&](const Row& row) {
+            return row.source == RemovedSource || snapshot.indexOf(getId(row)) < 0;
+        };
+
+        for (int last = rowList.length() - 1; last >= 0; last--) {
+            if (!isGone(rowList[last])) {
+                continue;
+            }
+
+            int first = last;
+            while (first > 0 && isGone(rowList[first - 1])) {
+                first--;
+            }
+
+            beginRemoveRows(QModelIndex(), first, last);
+            rowList.erase(rowList.begin() + first, rowList.begin() + last + 1);
+            endRemoveRows();
+
+            last = first;
+        }
+        removedDesktopList.clear();
+    }
+
+    // Rows before r are final or removed, so each row is either in place,
+    // further down the list if it was moved, or not present at all
+    int r = 0;
+    for (int i = 0; i < snapshot.count(); i++) {
+        while (r < rowList.length() && rowList[r].source == RemovedSource) {
+            r++;
+        }
+
+        auto& id = snapshot.getId(i);
+
+        if (previousSnapshot.indexOf(id) < 0) {
+            beginInsertRows(QModelIndex(), r, r);
+            rowList.insert(r, Row{ CurrentSource, i });
+            endInsertRows();
+            r++;
+            continue;
+        }
+
+        if (getId(rowList[r]) != id) {
+            int j = r + 1;
+            while (rowList[j].source == RemovedSource || getId(rowList[j]) != id) {
+                j++;
+            }
+
+            beginMoveRows(QModelIndex(), j, j, QModelIndex(), r);
+            rowList.move(j, r);
+            endMoveRows();
+        }
+
+        auto changedRoles = getChangedRoles(previousSnapshot, rowList[r].index, snapshot, i);
+        rowList[r] = Row{ CurrentSource, i };
+        if (!changedRoles.isEmpty()) {
+            emit dataChanged(index(r), index(r), changedRoles);
+        }
+        r++;
+    }
+
+    previousSnapshot = DesktopSnapshot();
+}
+
+void DesktopListModel::setRemovalDeferred(bool isRemovalDeferred) {
+    this->isRemovalDeferred = isRemovalDeferred;
+
+    if (!isRemovalDeferred) {
+        for (int i = rowList.length() - 1; i >= 0; i--) {
+            if (rowList[i].source == RemovedSource) {
+                removeRow(i);
+            }
+        }
+    }
+}
+
+void DesktopListModel::releaseRemovedRow(const QString& id) {
+    for (int i = 0; i < rowList.length(); i++) {
+        if (rowList[i].source == RemovedSource && removedDesktopList[rowList[i].index].id == id) {
+            removeRow(i);
+            return;
+        }
+    }
+}
+
+void DesktopListModel::removeRow(int i) {
+    int removedIndex = rowList[i].index;
+
+    beginRemoveRows(QModelIndex(), i, i);
+    rowList.removeAt(i);
+    removedDesktopList.removeAt(removedIndex);
+    for (auto& row : rowList) {
+        if (row.source == RemovedSource && row.index > removedIndex) {
+            row.index--;
+        }
+    }
+    endRemoveRows();
+}
+
+const QString& DesktopListModel::getId(const Row& row) const {
+    switch (row.source) {
+        case PreviousSource:
+            return previousSnapshot.getId(row.index);
+        case RemovedSource:
+            return removedDesktopList[row.index].id;
+        case CurrentSource:
+            break;
+    }
+    return snapshot.getId(row.index);
+}
+
+QVector<int> DesktopListModel::getChangedRoles(const DesktopSnapshot& oldSnapshot, int oldIndex,
+                                               const DesktopSnapshot& newSnapshot, int newIndex) {
+    QVector<int> changedRoles;
+    if (oldSnapshot.getNumber(oldIndex) != newSnapshot.getNumber(newIndex)) {
+        changedRoles << NumberRole;
+    }
+    if (oldSnapshot.getName(oldIndex) != newSnapshot.getName(newIndex)) {
+        changedRoles << NameRole;
+    }
+    if (oldSnapshot.isCurrent(oldIndex) != newSnapshot.isCurrent(newIndex)) {
+        changedRoles << IsCurrentRole;
+    }
+    if (oldSnapshot.isEmpty(oldIndex) != newSnapshot.isEmpty(newIndex)) {
+        changedRoles << IsEmptyRole;
+    }
+    if (oldSnapshot.isUrgent(oldIndex) != newSnapshot.isUrgent(newIndex)) {
+        changedRoles << IsUrgentRole;
+    }
+    if (oldSnapshot.getActiveWindowName(oldIndex) != newSnapshot.getActiveWindowName(newIndex)) {
+        changedRoles << ActiveWindowNameRole;
+    }
+    if (oldSnapshot.getWindowCount(oldIndex) != newSnapshot.getWindowCount(newIndex)) {
+        changedRoles << WindowCountRole;
+    }
+    return changedRoles;
+}
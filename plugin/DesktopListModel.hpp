@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "DesktopSnapshot.hpp"
+
+class DesktopListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Role {
+        NumberRole = Qt::UserRole + 1,
+        IdRole,
+        NameRole,
+        IsCurrentRole,
+        IsEmptyRole,
+        IsUrgentRole,
+        ActiveWindowNameRole,
+        WindowCountRole,
+        IsRemovedRole
+    };
+
+    DesktopListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // Takes over the snapshot and brings the rows to its state, notifying
+    // only about removed, moved and inserted rows and the roles that changed
+    void update(DesktopSnapshot&& newSnapshot);
+
+    // When deferred, rows of removed desktops are kept, flagged as removed,
+    // until the view releases them, so it can animate them going away
+    void setRemovalDeferred(bool isRemovalDeferred);
+    Q_INVOKABLE void releaseRemovedRow(const QString& id);
+
+private:
+    // While updating, some rows still show desktops of the previous snapshot,
+    // rows of removed desktops show what they were when they were removed
+    enum Source {
+        CurrentSource,
+        PreviousSource,
+        RemovedSource
+    };
+
+    class Row {
+    public:
+        Source source;
+        int index;
+    };
+
+    class RemovedDesktop {
+    public:
+        int number;
+        QString id;
+        QString name;
+        bool isEmpty;
+        bool isUrgent;
+        QString activeWindowName;
+        int windowCount;
+    };
+
+    DesktopSnapshot snapshot;
+    DesktopSnapshot previousSnapshot;
+    QVector<Row> rowList;
+
+    bool isRemovalDeferred;
+    QList<RemovedDesktop> removedDesktopList;
+    void removeRow(int i);
+
+    const QString& getId(const Row& row) const;
+
+    static QVector<int> getChangedRoles(const DesktopSnapshot& oldSnapshot, int oldIndex,
+                                        const DesktopSnapshot& newSnapshot, int newIndex);
+};
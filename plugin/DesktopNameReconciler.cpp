@@ -0,0 +1,128 @@
+#include "DesktopNameReconciler.hpp"
+
+#include <QStringList>
+
+#include "X11Batch.hpp"
+
+DesktopNameReconciler::DesktopNameReconciler(WindowSystemBackend* backend, const DesktopTable* desktopTable,
+                                             QObject* parent) : QObject(parent),
+        backend(backend),
+        desktopTable(desktopTable),
+        callCount(0) {
+
+    timeoutTimer.setSingleShot(true);
+    timeoutTimer.setInterval(1000);
+    QObject::connect(&timeoutTimer, &QTimer::timeout, this, [&] {
+        settle();
+    });
+}
+
+void DesktopNameReconciler::reconcile(const QHash<QString, QString>& targetNameHash) {
+    QHash<QString, QString> renameHash;
+    for (auto it = targetNameHash.constBegin(); it != targetNameHash.constEnd(); it++) {
+        auto* desktopInfo = desktopTable->find(it.key());
+        if (!desktopInfo) {
+            continue;
+        }
+
+        // A rename still in flight decides the name the desktop ends up with
+        if (pendingNameHash.value(it.key(), desktopInfo->name) != it.value()) {
+            renameHash.insert(it.key(), it.value());
+        }
+    }
+
+    if (renameHash.isEmpty()) {
+        return;
+    }
+
+    timeoutTimer.start();
+
+    for (auto it = renameHash.constBegin(); it != renameHash.constEnd(); it++) {
+        QString id = it.key();
+        QString name = it.value();
+
+        pendingNameHash.insert(id, name);
+        callCount++;
+
+        backend->renameDesktop(id, name, [this, id, name](bool isSuccessful) {
+            if (!isSuccessful) {
+                fallbackNameHash.insert(id, name);
+            }
+            if (--callCount == 0) {
+                applyFallback();
+                trySettle();
+            }
+        });
+    }
+}
+
+bool DesktopNameReconciler::acknowledge() {
+    bool isForeignChange = false;
+
+    QHash<QString, QString> nameHash;
+    for (auto& desktopInfo : desktopTable->getDesktopInfoList()) {
+        nameHash.insert(desktopInfo.id, desktopInfo.name);
+
+        auto knownIt = knownNameHash.constFind(desktopInfo.id);
+        if (knownIt != knownNameHash.constEnd() && knownIt.value() == desktopInfo.name) {
+            continue;
+        }
+
+        auto pendingIt = pendingNameHash.find(desktopInfo.id);
+        if (pendingIt != pendingNameHash.end() && pendingIt.value() == desktopInfo.name) {
+            pendingNameHash.erase(pendingIt);
+        } else {
+            isForeignChange = true;
+        }
+    }
+    knownNameHash = nameHash;
+
+    // Renames of desktops removed in the meantime will never be reflected
+    auto it = pendingNameHash.begin();
+    while (it != pendingNameHash.end()) {
+        if (nameHash.contains(it.key())) {
+            it++;
+        } else {
+            it = pendingNameHash.erase(it);
+        }
+    }
+
+    trySettle();
+
+    return isForeignChange;
+}
+
+bool DesktopNameReconciler::isPending() const {
+    return timeoutTimer.isActive();
+}
+
+void DesktopNameReconciler::applyFallback() {
+    if (fallbackNameHash.isEmpty()) {
+        return;
+    }
+
+    // The window system only takes all the names at once, so the ones
+    // of the other desktops are those they are expected to end up with
+    QStringList nameList;
+    for (auto& desktopInfo : desktopTable->getDesktopInfoList()) {
+        nameList << fallbackNameHash.value(desktopInfo.id,
+                                           pendingNameHash.value(desktopInfo.id, desktopInfo.name));
+    }
+    fallbackNameHash.clear();
+
+    X11Batch batch;
+    batch.setDesktopNames(nameList);
+    backend->commit(batch);
+}
+
+void DesktopNameReconciler::trySettle() {
+    if (timeoutTimer.isActive() && pendingNameHash.isEmpty() && callCount == 0) {
+        settle();
+    }
+}
+
+void DesktopNameReconciler::settle() {
+    timeoutTimer.stop();
+    pendingNameHash.clear();
+    emit settled();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "DesktopTable.hpp"
+#include "WindowSystemBackend.hpp"
+
+// Brings desktop names to a desired state with as few requests as possible:
+// the desired names are compared against the desktop table and the renames
+// still in flight, only the differing ones are sent, all at once, and the
+// name changes they cause are told apart from the ones made by others
+class DesktopNameReconciler : public QObject {
+    Q_OBJECT
+
+public:
+    DesktopNameReconciler(WindowSystemBackend* backend, const DesktopTable* desktopTable,
+                          QObject* parent = nullptr);
+
+    // Takes the desired names by desktop id, desktops left out keep theirs
+    void reconcile(const QHash<QString, QString>& targetNameHash);
+
+    // To be called whenever the desktop table reports changed names,
+    // returns whether any of the changes was not made by the reconciler
+    bool acknowledge();
+
+    bool isPending() const;
+
+signals:
+    // Emitted once all the renames sent are reflected in the desktop table,
+    // or once the timeout elapses if some of them never are
+    void settled();
+
+private:
+    WindowSystemBackend* backend;
+    const DesktopTable* desktopTable;
+
+    // Names as of the last acknowledged change, and names expected to come
+    QHash<QString, QString> knownNameHash;
+    QHash<QString, QString> pendingNameHash;
+    QTimer timeoutTimer;
+
+    // Renames the desktop manager refused are sent
+    // to the window system in a single batch at the end
+    int callCount;
+    QHash<QString, QString> fallbackNameHash;
+    void applyFallback();
+
+    void trySettle();
+    void settle();
+};
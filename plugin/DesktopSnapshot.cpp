@@ -0,0 +1,95 @@
+#include "DesktopSnapshot.hpp"
+
+#include <utility>
+
+int DesktopSnapshot::count() const {
+    return idList.size();
+}
+
+int DesktopSnapshot::indexOf(const QString& id) const {
+    return indexHash.value(id, -1);
+}
+
+int DesktopSnapshot::getNumber(int i) const {
+    return numberList[i];
+}
+
+const QString& DesktopSnapshot::getId(int i) const {
+    return idList[i];
+}
+
+const QString& DesktopSnapshot::getName(int i) const {
+    return nameList[i];
+}
+
+const QString& DesktopSnapshot::getActiveWindowName(int i) const {
+    return activeWindowNameList[i];
+}
+
+int DesktopSnapshot::getWindowCount(int i) const {
+    return windowCountList[i];
+}
+
+bool DesktopSnapshot::isCurrent(int i) const {
+    return i == currentIndex;
+}
+
+bool DesktopSnapshot::isEmpty(int i) const {
+    return emptyBits.testBit(i);
+}
+
+bool DesktopSnapshot::isUrgent(int i) const {
+    return urgentBits.testBit(i);
+}
+
+DesktopSnapshot::Builder::Builder(int capacity) {
+    snapshot.numberList.reserve(capacity);
+    snapshot.idList.reserve(capacity);
+    snapshot.nameList.reserve(capacity);
+    snapshot.activeWindowNameList.reserve(capacity);
+    snapshot.windowCountList.reserve(capacity);
+    snapshot.emptyBits.resize(capacity);
+    snapshot.urgentBits.resize(capacity);
+}
+
+void DesktopSnapshot::Builder::append(int number, const QString& id, const QString& name) {
+    int i = snapshot.idList.size();
+
+    snapshot.numberList << number;
+    snapshot.idList << id;
+    snapshot.nameList << name;
+    snapshot.activeWindowNameList << QString();
+    snapshot.windowCountList << 0;
+
+    if (i >= snapshot.emptyBits.size()) {
+        snapshot.emptyBits.resize(i + 1);
+        snapshot.urgentBits.resize(i + 1);
+    }
+    snapshot.emptyBits.setBit(i, true);
+    snapshot.urgentBits.setBit(i, false);
+}
+
+void DesktopSnapshot::Builder::setCurrent() {
+    snapshot.currentIndex = snapshot.idList.size() - 1;
+}
+
+void DesktopSnapshot::Builder::setWindows(int windowCount, bool isUrgent, const QString& activeWindowName) {
+    int i = snapshot.idList.size() - 1;
+
+    snapshot.windowCountList[i] = windowCount;
+    snapshot.emptyBits.setBit(i, windowCount == 0);
+    snapshot.urgentBits.setBit(i, isUrgent);
+    snapshot.activeWindowNameList[i] = activeWindowName;
+}
+
+DesktopSnapshot DesktopSnapshot::Builder::build() {
+    snapshot.emptyBits.resize(snapshot.idList.size());
+    snapshot.urgentBits.resize(snapshot.idList.size());
+
+    snapshot.indexHash.reserve(snapshot.idList.size());
+    for (int i = 0; i < snapshot.idList.size(); i++) {
+        snapshot.indexHash.insert(snapshot.idList[i], i);
+    }
+
+    return std::move(snapshot);
+}
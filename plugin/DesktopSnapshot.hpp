@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QBitArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// State of all the desktops as shown by an applet, built once per refresh
+// and never modified afterwards. Fields are kept in separate contiguous
+// arrays and flags in packed bit arrays, besides the hash of ids, which is
+// built once the snapshot is complete so model updates look desktops up in
+// constant time. Snapshots can only be moved, lookups return references
+// into the snapshot itself
+class DesktopSnapshot {
+public:
+    class Builder;
+
+    DesktopSnapshot() = default;
+    DesktopSnapshot(DesktopSnapshot&& other) = default;
+    DesktopSnapshot& operator=(DesktopSnapshot&& other) = default;
+
+    DesktopSnapshot(const DesktopSnapshot& other) = delete;
+    DesktopSnapshot& operator=(const DesktopSnapshot& other) = delete;
+
+    int count() const;
+
+    // Index of the desktop with the given id, or -1 if there is none
+    int indexOf(const QString& id) const;
+
+    int getNumber(int i) const;
+    const QString& getId(int i) const;
+    const QString& getName(int i) const;
+    const QString& getActiveWindowName(int i) const;
+    int getWindowCount(int i) const;
+
+    bool isCurrent(int i) const;
+    bool isEmpty(int i) const;
+    bool isUrgent(int i) const;
+
+private:
+    QVector<int> numberList;
+    QVector<QString> idList;
+    QVector<QString> nameList;
+    QVector<QString> activeWindowNameList;
+    QVector<int> windowCountList;
+
+    QBitArray emptyBits;
+    QBitArray urgentBits;
+    int currentIndex = -1;
+
+    QHash<QString, int> indexHash;
+};
+
+class DesktopSnapshot::Builder {
+public:
+    Builder(int capacity);
+
+    // Desktops are appended in the order they are shown in,
+    // the setters apply to the one appended last
+    void append(int number, const QString& id, const QString& name);
+    void setCurrent();
+    void setWindows(int windowCount, bool isUrgent, const QString& activeWindowName);
+
+    // Hands the snapshot over, the builder must not be used afterwards
+    DesktopSnapshot build();
+
+private:
+    DesktopSnapshot snapshot;
+};
@@ -0,0 +1,158 @@
+#include "DesktopTable.hpp"
+
+#include <QStringList>
+
+DesktopTable::DesktopTable(WindowSystemBackend* backend, QObject* parent) : QObject(parent),
+        backend(backend),
+        isUsingDesktopManager(false),
+        nextFallbackId(1) {}
+
+void DesktopTable::populate() {
+    populateFromWindowSystem();
+
+    QObject::connect(backend, &WindowSystemBackend::numberOfDesktopsChanged, this, [&] {
+        if (!isUsingDesktopManager) {
+            populateFromWindowSystem();
+            emit desktopCountChanged();
+        }
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopNamesChanged, this, [&] {
+        if (!isUsingDesktopManager) {
+            populateFromWindowSystem();
+            emit desktopNamesChanged();
+        }
+    });
+
+    connectToDesktopManagerSignals();
+
+    backend->fetchDesktops([this](bool isValid, const QList<DesktopInfo>& newDesktopInfoList) {
+        if (!isValid) {
+            return;
+        }
+
+        desktopInfoList = newDesktopInfoList;
+        desktopIndexHash.clear();
+        renumber();
+
+        isUsingDesktopManager = true;
+        emit desktopCountChanged();
+    });
+}
+
+int DesktopTable::count() const {
+    return desktopInfoList.length();
+}
+
+const DesktopInfo* DesktopTable::find(int number) const {
+    if (number < 1 || number > desktopInfoList.length()) {
+        return nullptr;
+    }
+    return &desktopInfoList[number - 1];
+}
+
+const DesktopInfo* DesktopTable::find(const QString& id) const {
+    int index = desktopIndexHash.value(id, -1);
+    return index >= 0 ? &desktopInfoList[index] : nullptr;
+}
+
+const QList<DesktopInfo>& DesktopTable::getDesktopInfoList() const {
+    return desktopInfoList;
+}
+
+void DesktopTable::expectRemoval(const QList<int>& numbers) {
+    if (isUsingDesktopManager) {
+        return;
+    }
+
+    for (int number : numbers) {
+        if (auto* desktopInfo = find(number)) {
+            expectedRemovedIdSet.insert(desktopInfo->id);
+        }
+    }
+}
+
+void DesktopTable::populateFromWindowSystem() {
+    QStringList idList;
+    for (auto& desktopInfo : desktopInfoList) {
+        if (!expectedRemovedIdSet.contains(desktopInfo.id)) {
+            idList << desktopInfo.id;
+        }
+    }
+    expectedRemovedIdSet.clear();
+
+    desktopInfoList.clear();
+    desktopIndexHash.clear();
+
+    for (int i = 1; i <= backend->numberOfDesktops(); i++) {
+        DesktopInfo desktopInfo;
+        desktopInfo.id = i <= idList.length() ? idList[i - 1] : QString::number(nextFallbackId++);
+        desktopInfo.name = backend->desktopName(i);
+        desktopInfoList << desktopInfo;
+    }
+
+    renumber();
+}
+
+void DesktopTable::connectToDesktopManagerSignals() {
+    QObject::connect(backend, &WindowSystemBackend::desktopCreated, this, [&](const DesktopInfo& desktopInfo) {
+        if (!isUsingDesktopManager) {
+            return;
+        }
+
+        int index = qBound(0, desktopInfo.number - 1, desktopInfoList.length());
+        desktopInfoList.insert(index, desktopInfo);
+        renumber(index);
+
+        emit desktopCountChanged();
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopRemoved, this, [&](const QString& id) {
+        int index = desktopIndexHash.value(id, -1);
+        if (!isUsingDesktopManager || index < 0) {
+            return;
+        }
+
+        desktopInfoList.removeAt(index);
+        desktopIndexHash.remove(id);
+        renumber(index);
+
+        emit desktopCountChanged();
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopDataChanged, this, [&](const DesktopInfo& desktopInfo) {
+        int index = desktopIndexHash.value(desktopInfo.id, -1);
+        if (!isUsingDesktopManager || index < 0) {
+            return;
+        }
+
+        desktopInfoList[index].name = desktopInfo.name;
+
+        int newIndex = qBound(0, desktopInfo.number - 1, desktopInfoList.length() - 1);
+        if (newIndex != index) {
+            desktopInfoList.move(index, newIndex);
+            renumber(qMin(index, newIndex));
+        }
+
+        emit desktopNamesChanged();
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopsChanged, this, [&](const QList<DesktopInfo>& newDesktopInfoList) {
+        if (!isUsingDesktopManager) {
+            return;
+        }
+
+        desktopInfoList = newDesktopInfoList;
+        desktopIndexHash.clear();
+        renumber();
+
+        emit desktopCountChanged();
+    });
+}
+
+void DesktopTable::renumber(int fromIndex) {
+    for (int i = fromIndex; i < desktopInfoList.length(); i++) {
+        desktopInfoList[i].number = i + 1;
+        desktopIndexHash.insert(desktopInfoList[i].id, i);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+#include "DesktopInfo.hpp"
+#include "WindowSystemBackend.hpp"
+
+class DesktopTable : public QObject {
+    Q_OBJECT
+
+public:
+    DesktopTable(WindowSystemBackend* backend, QObject* parent = nullptr);
+
+    // Starts with the desktop list known to the window system, then asynchronously
+    // fetches it from the desktop manager and keeps it up to date with its signals,
+    // or with the window system's ones if the desktop manager is not available
+    void populate();
+
+    int count() const;
+    const DesktopInfo* find(int number) const;
+    const DesktopInfo* find(const QString& id) const;
+    const QList<DesktopInfo>& getDesktopInfoList() const;
+
+    // Without the desktop manager, desktops are only known by their numbers,
+    // so the table has to be told which ones the desktops removed through
+    // the window system were, for the others to keep their ids
+    void expectRemoval(const QList<int>& numbers);
+
+signals:
+    void desktopCountChanged();
+    void desktopNamesChanged();
+
+private:
+    WindowSystemBackend* backend;
+    bool isUsingDesktopManager;
+
+    QList<DesktopInfo> desktopInfoList;
+    QHash<QString, int> desktopIndexHash;
+
+    // Desktops known through the window system keep the ids they got
+    // by their position, new ones get ids never given out before
+    int nextFallbackId;
+    QSet<QString> expectedRemovedIdSet;
+
+    void populateFromWindowSystem();
+    void connectToDesktopManagerSignals();
+    void renumber(int fromIndex = 0);
+};
@@ -0,0 +1,126 @@
+#include "DynamicDesktopPolicy.hpp"
+
+DynamicDesktopPolicy::DynamicDesktopPolicy(QObject* parent) : QObject(parent),
+        isEnabled(false),
+        removalDelay(0),
+        minimumInterval(0),
+        lastChangeTime(-1),
+        awaitedDesktopCount(-1) {
+
+    clock.start();
+
+    timer.setSingleShot(true);
+    QObject::connect(&timer, &QTimer::timeout, this, [&] {
+        evaluate();
+    });
+}
+
+void DynamicDesktopPolicy::setEnabled(bool isEnabled) {
+    this->isEnabled = isEnabled;
+    if (!isEnabled) {
+        timer.stop();
+        emptySinceHash.clear();
+        awaitedDesktopCount = -1;
+    }
+}
+
+void DynamicDesktopPolicy::setRemovalDelay(int msec) {
+    removalDelay = qMax(0, msec);
+}
+
+void DynamicDesktopPolicy::setMinimumInterval(int msec) {
+    minimumInterval = qMax(0, msec);
+}
+
+void DynamicDesktopPolicy::update(const QStringList& desktopIdList, const QSet<QString>& emptyDesktopIdSet) {
+    if (!isEnabled) {
+        return;
+    }
+
+    if (desktopIdList.length() != awaitedDesktopCount) {
+        awaitedDesktopCount = -1;
+    }
+
+    // Desktops are timed from the first update they were seen empty in
+    qint64 now = clock.elapsed();
+    for (auto& id : emptyDesktopIdSet) {
+        if (!emptySinceHash.contains(id)) {
+            emptySinceHash.insert(id, now);
+        }
+    }
+    auto it = emptySinceHash.begin();
+    while (it != emptySinceHash.end()) {
+        if (emptyDesktopIdSet.contains(it.key())) {
+            it++;
+        } else {
+            it = emptySinceHash.erase(it);
+        }
+    }
+
+    this->desktopIdList = desktopIdList;
+    this->emptyDesktopIdSet = emptyDesktopIdSet;
+
+    evaluate();
+}
+
+void DynamicDesktopPolicy::evaluate() {
+    if (!isEnabled) {
+        return;
+    }
+
+    qint64 now = clock.elapsed();
+
+    if (awaitedDesktopCount >= 0 && now - lastChangeTime < settleTimeout) {
+        timer.start(settleTimeout - (now - lastChangeTime));
+        return;
+    }
+    awaitedDesktopCount = -1;
+
+    if (lastChangeTime >= 0 && now - lastChangeTime < minimumInterval) {
+        timer.start(minimumInterval - (now - lastChangeTime));
+        return;
+    }
+
+    if (emptyDesktopIdSet.isEmpty()) {
+        timer.stop();
+        lastChangeTime = now;
+        awaitedDesktopCount = desktopIdList.length();
+        emit addDesktopRequested();
+        return;
+    }
+
+    // The first empty desktop is kept, the others are removed
+    // once they have been empty for long enough
+    QStringList removedIdList;
+    qint64 nextDeadline = -1;
+    bool isFirstEmptyDesktop = true;
+
+    for (auto& id : desktopIdList) {
+        if (!emptyDesktopIdSet.contains(id)) {
+            continue;
+        }
+        if (isFirstEmptyDesktop) {
+            isFirstEmptyDesktop = false;
+            continue;
+        }
+
+        qint64 emptyTime = now - emptySinceHash.value(id, now);
+        if (emptyTime >= removalDelay) {
+            removedIdList << id;
+        } else if (nextDeadline < 0 || removalDelay - emptyTime < nextDeadline) {
+            nextDeadline = removalDelay - emptyTime;
+        }
+    }
+
+    if (!removedIdList.isEmpty()) {
+        lastChangeTime = now;
+        awaitedDesktopCount = desktopIdList.length();
+        emit removeDesktopsRequested(removedIdList);
+    }
+
+    if (nextDeadline >= 0) {
+        timer.start(qMax(nextDeadline, qint64(minimumInterval)));
+    } else {
+        timer.stop();
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+// Decides when dynamic desktops are added and removed, so short-lived
+// windows do not make desktops come and go: a desktop is removed only
+// after staying empty for the removal delay, changes are at least the
+// minimum interval apart, and all the decisions made in the meantime
+// are merged into the single net change the latest state calls for
+class DynamicDesktopPolicy : public QObject {
+    Q_OBJECT
+
+public:
+    DynamicDesktopPolicy(QObject* parent = nullptr);
+
+    void setEnabled(bool isEnabled);
+    void setRemovalDelay(int msec);
+    void setMinimumInterval(int msec);
+
+    // Takes the ids of all the desktops in order and of the empty ones
+    void update(const QStringList& desktopIdList, const QSet<QString>& emptyDesktopIdSet);
+
+signals:
+    void addDesktopRequested();
+    void removeDesktopsRequested(const QStringList& idList);
+
+private:
+    bool isEnabled;
+    int removalDelay;
+    int minimumInterval;
+
+    QStringList desktopIdList;
+    QSet<QString> emptyDesktopIdSet;
+    QHash<QString, qint64> emptySinceHash;
+
+    QElapsedTimer clock;
+    QTimer timer;
+    qint64 lastChangeTime;
+
+    // A change is awaited until the number of desktops differs from
+    // the one it was requested at, or until the settle timeout elapses
+    int awaitedDesktopCount;
+    static const int settleTimeout = 2000;
+
+    void evaluate();
+};
@@ -0,0 +1,356 @@
+#include "KWinBackend.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusPendingCallWatcher>
+#include <QDBusVariant>
+#include <QGuiApplication>
+#include <QSharedPointer>
+#include <QX11Info>
+
+#include <xcb/xcb.h>
+
+namespace {
+
+class Atoms {
+public:
+    xcb_atom_t netWmDesktop = XCB_ATOM_NONE;
+    xcb_atom_t netDesktopNames = XCB_ATOM_NONE;
+    xcb_atom_t netNumberOfDesktops = XCB_ATOM_NONE;
+    xcb_atom_t netCurrentDesktop = XCB_ATOM_NONE;
+    xcb_atom_t utf8String = XCB_ATOM_NONE;
+};
+
+// Interning all the atoms at once, so it only costs a single round trip
+const Atoms& getAtoms(xcb_connection_t* connection) {
+    static Atoms atoms;
+    static bool isInterned = false;
+
+    if (!isInterned) {
+        const char* names[] = { "_NET_WM_DESKTOP", "_NET_DESKTOP_NAMES",
+                                "_NET_NUMBER_OF_DESKTOPS", "_NET_CURRENT_DESKTOP",
+                                "UTF8_STRING" };
+        xcb_atom_t* targets[] = { &atoms.netWmDesktop, &atoms.netDesktopNames,
+                                  &atoms.netNumberOfDesktops, &atoms.netCurrentDesktop,
+                                  &atoms.utf8String };
+
+        const int n = sizeof(names) / sizeof(names[0]);
+        xcb_intern_atom_cookie_t cookies[n];
+        for (int i = 0; i < n; i++) {
+            cookies[i] = xcb_intern_atom(connection, false, strlen(names[i]), names[i]);
+        }
+        for (int i = 0; i < n; i++) {
+            auto* reply = xcb_intern_atom_reply(connection, cookies[i], nullptr);
+            if (reply) {
+                *targets[i] = reply->atom;
+                free(reply);
+            }
+        }
+
+        isInterned = true;
+    }
+
+    return atoms;
+}
+
+void sendClientMessage(xcb_connection_t* connection, xcb_window_t root,
+                       xcb_window_t window, xcb_atom_t type,
+                       uint32_t data0, uint32_t data1 = 0) {
+    xcb_client_message_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.response_type = XCB_CLIENT_MESSAGE;
+    event.format = 32;
+    event.window = window;
+    event.type = type;
+    event.data.data32[0] = data0;
+    event.data.data32[1] = data1;
+
+    xcb_send_event(connection, false, root,
+                   XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY | XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT,
+                   reinterpret_cast<const char*>(&event));
+}
+
+}
+
+KWinBackend::KWinBackend(QObject* parent) : WindowSystemBackend(parent),
+        dbusServiceName("org.kde.KWin"),
+        dbusPath("/VirtualDesktopManager"),
+        dbusInterfaceName("org.kde.KWin.VirtualDesktopManager"),
+        netRootInfo(QX11Info::connection(), 0),
+        windowEnumerator(QX11Info::connection(), QX11Info::appRootWindow()) {
+
+    connectToKWindowSystemSignals();
+
+    for (auto* screen : QGuiApplication::screens()) {
+        connectToScreenSignals(screen);
+    }
+
+    QObject::connect(qGuiApp, &QGuiApplication::screenAdded, this, [&](QScreen* screen) {
+        connectToScreenSignals(screen);
+        emit screensChanged();
+    });
+
+    QObject::connect(qGuiApp, &QGuiApplication::screenRemoved, this, [&] {
+        emit screensChanged();
+    });
+
+    // Signals emitted before KWin handles a fetch are already reflected in its reply
+    connectToDBusSignals();
+}
+
+int KWinBackend::currentDesktop() const {
+    return KWindowSystem::currentDesktop();
+}
+
+int KWinBackend::numberOfDesktops() const {
+    return KWindowSystem::numberOfDesktops();
+}
+
+QString KWinBackend::desktopName(int number) const {
+    return KWindowSystem::desktopName(number);
+}
+
+QList<WId> KWinBackend::windows() const {
+    return KWindowSystem::windows();
+}
+
+QList<WId> KWinBackend::stackingOrder() const {
+    return KWindowSystem::stackingOrder();
+}
+
+QList<ScreenInfo> KWinBackend::screens() const {
+    QList<ScreenInfo> screenInfoList;
+    for (auto* screen : QGuiApplication::screens()) {
+        ScreenInfo screenInfo;
+        screenInfo.name = screen->name();
+        screenInfo.geometry = screen->geometry();
+        screenInfoList << screenInfo;
+    }
+    return screenInfoList;
+}
+
+bool KWinBackend::fetchWindow(WId id, NET::Properties properties, WindowProperties& windowProperties) {
+    auto windowPropertiesHash = windowEnumerator.fetch({ id }, properties);
+    auto it = windowPropertiesHash.constFind(id);
+    if (it == windowPropertiesHash.constEnd()) {
+        return false;
+    }
+
+    windowProperties.copy(*it, properties);
+    return true;
+}
+
+QHash<WId, WindowProperties> KWinBackend::fetchWindows(const QList<WId>& idList, NET::Properties properties) {
+    return windowEnumerator.fetch(idList, properties);
+}
+
+KWinBackend::WindowFetchFunction KWinBackend::createWindowFetchFunction() {
+    // A connection of its own, so requests from another thread
+    // do not interleave with the ones made by Qt and KWindowSystem
+    auto* connection = xcb_connect(nullptr, nullptr);
+    if (xcb_connection_has_error(connection)) {
+        xcb_disconnect(connection);
+        return nullptr;
+    }
+
+    auto windowEnumerator = QSharedPointer<X11WindowEnumerator>(
+        new X11WindowEnumerator(connection, QX11Info::appRootWindow()),
+        [connection](X11WindowEnumerator* windowEnumerator) {
+            delete windowEnumerator;
+            xcb_disconnect(connection);
+        });
+
+    return [windowEnumerator](const QList<WId>& idList, NET::Properties properties) {
+        return windowEnumerator->fetch(idList, properties);
+    };
+}
+
+void KWinBackend::setCurrentDesktop(int number) {
+    KWindowSystem::setCurrentDesktop(number);
+}
+
+void KWinBackend::setNumberOfDesktops(int numberOfDesktops) {
+    netRootInfo.setNumberOfDesktops(numberOfDesktops);
+}
+
+void KWinBackend::setDesktopName(int number, const QString& name) {
+    KWindowSystem::setDesktopName(number, name);
+}
+
+void KWinBackend::commit(X11Batch& batch) {
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    auto* connection = QX11Info::connection();
+    xcb_window_t root = QX11Info::appRootWindow();
+    auto& atoms = getAtoms(connection);
+
+    // Source indication 2 means the request comes from a pager
+    for (auto& windowMove : batch.getWindowMoveList()) {
+        sendClientMessage(connection, root, windowMove.first, atoms.netWmDesktop,
+                          windowMove.second - 1, 2);
+    }
+
+    if (batch.hasDesktopNames()) {
+        QByteArray data;
+        for (auto& desktopName : batch.getDesktopNameList()) {
+            data += desktopName.toUtf8();
+            data += '\0';
+        }
+        xcb_change_property(connection, XCB_PROP_MODE_REPLACE, root,
+                            atoms.netDesktopNames, atoms.utf8String,
+                            8, data.size(), data.constData());
+    }
+
+    if (batch.getNumberOfDesktops() > 0) {
+        sendClientMessage(connection, root, root, atoms.netNumberOfDesktops,
+                          batch.getNumberOfDesktops());
+    }
+
+    if (batch.getCurrentDesktopNumber() > 0) {
+        sendClientMessage(connection, root, root, atoms.netCurrentDesktop,
+                          batch.getCurrentDesktopNumber() - 1);
+    }
+
+    xcb_flush(connection);
+
+    batch.clear();
+}
+
+void KWinBackend::fetchDesktops(DesktopListCallback callback) {
+    auto message = QDBusMessage::createMethodCall(dbusServiceName, dbusPath,
+                                                  "org.freedesktop.DBus.Properties", "Get");
+    message << dbusInterfaceName << QString("desktops");
+
+    dbusCallQueue.enqueue(message, [this, callback](const QDBusMessage& reply) {
+        QList<DesktopInfo> desktopInfoList;
+        if (reply.type() == QDBusMessage::ErrorMessage || reply.arguments().isEmpty()) {
+            emit desktopsFetched(false, desktopInfoList);
+            callback(false, desktopInfoList);
+            return;
+        }
+
+        // Extracting data from the D-Bus reply message here
+        // More details at https://stackoverflow.com/a/20206377
+        auto something = reply.arguments().at(0).value<QDBusVariant>();
+        auto somethingSomething = something.variant().value<QDBusArgument>();
+        somethingSomething >> desktopInfoList;
+
+        emit desktopsFetched(true, desktopInfoList);
+        callback(true, desktopInfoList);
+    });
+}
+
+void KWinBackend::removeDesktop(const QString& id, ResultCallback callback) {
+    auto message = createDBusMethodCall("removeDesktop");
+    message << id;
+
+    dbusCallQueue.enqueue(message, [this, id, callback](const QDBusMessage& reply) {
+        bool isSuccessful = reply.type() != QDBusMessage::ErrorMessage;
+        emit desktopRemoveFinished(id, isSuccessful);
+        callback(isSuccessful);
+    });
+}
+
+void KWinBackend::renameDesktop(const QString& id, const QString& name, ResultCallback callback) {
+    auto message = createDBusMethodCall("setDesktopName");
+    message << id << name;
+
+    dbusCallQueue.enqueue(message, [this, id, name, callback](const QDBusMessage& reply) {
+        bool isSuccessful = reply.type() != QDBusMessage::ErrorMessage;
+        emit desktopRenameFinished(id, name, isSuccessful);
+        callback(isSuccessful);
+    });
+}
+
+void KWinBackend::setStats(RefreshStats* stats) {
+    dbusCallQueue.setStats(stats);
+}
+
+void KWinBackend::onDesktopCreated(const QDBusMessage& message) {
+    if (message.arguments().length() < 2) {
+        return;
+    }
+
+    DesktopInfo desktopInfo;
+    message.arguments().at(1).value<QDBusArgument>() >> desktopInfo;
+    emit desktopCreated(desktopInfo);
+}
+
+void KWinBackend::onDesktopRemoved(const QDBusMessage& message) {
+    if (message.arguments().isEmpty()) {
+        return;
+    }
+
+    emit desktopRemoved(message.arguments().at(0).toString());
+}
+
+void KWinBackend::onDesktopDataChanged(const QDBusMessage& message) {
+    if (message.arguments().length() < 2) {
+        return;
+    }
+
+    DesktopInfo desktopInfo;
+    message.arguments().at(1).value<QDBusArgument>() >> desktopInfo;
+    emit desktopDataChanged(desktopInfo);
+}
+
+void KWinBackend::onDesktopsChanged(const QDBusMessage& message) {
+    if (message.arguments().isEmpty()) {
+        return;
+    }
+
+    QList<DesktopInfo> desktopInfoList;
+    message.arguments().at(0).value<QDBusArgument>() >> desktopInfoList;
+    emit desktopsChanged(desktopInfoList);
+}
+
+QDBusMessage KWinBackend::createDBusMethodCall(const QString& method) const {
+    return QDBusMessage::createMethodCall(dbusServiceName, dbusPath, dbusInterfaceName, method);
+}
+
+void KWinBackend::connectToKWindowSystemSignals() {
+    QObject::connect(KWindowSystem::self(), &KWindowSystem::currentDesktopChanged,
+                     this, &KWinBackend::currentDesktopChanged);
+
+    QObject::connect(KWindowSystem::self(), &KWindowSystem::numberOfDesktopsChanged,
+                     this, &KWinBackend::numberOfDesktopsChanged);
+
+    QObject::connect(KWindowSystem::self(), &KWindowSystem::desktopNamesChanged,
+                     this, &KWinBackend::desktopNamesChanged);
+
+    QObject::connect(KWindowSystem::self(), static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>
+                                            (&KWindowSystem::windowChanged),
+                     this, &KWinBackend::windowChanged);
+
+    QObject::connect(KWindowSystem::self(), &KWindowSystem::windowAdded,
+                     this, &KWinBackend::windowAdded);
+
+    QObject::connect(KWindowSystem::self(), &KWindowSystem::windowRemoved,
+                     this, &KWinBackend::windowRemoved);
+
+    QObject::connect(KWindowSystem::self(), &KWindowSystem::stackingOrderChanged,
+                     this, &KWinBackend::stackingOrderChanged);
+}
+
+void KWinBackend::connectToScreenSignals(QScreen* screen) {
+    QObject::connect(screen, &QScreen::geometryChanged, this, [&] {
+        emit screensChanged();
+    });
+}
+
+void KWinBackend::connectToDBusSignals() {
+    auto bus = QDBusConnection::sessionBus();
+    bus.connect(dbusServiceName, dbusPath, dbusInterfaceName, "desktopCreated",
+                this, SLOT(onDesktopCreated(QDBusMessage)));
+    bus.connect(dbusServiceName, dbusPath, dbusInterfaceName, "desktopRemoved",
+                this, SLOT(onDesktopRemoved(QDBusMessage)));
+    bus.connect(dbusServiceName, dbusPath, dbusInterfaceName, "desktopDataChanged",
+                this, SLOT(onDesktopDataChanged(QDBusMessage)));
+    bus.connect(dbusServiceName, dbusPath, dbusInterfaceName, "desktopsChanged",
+                this, SLOT(onDesktopsChanged(QDBusMessage)));
+}
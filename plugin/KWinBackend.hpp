@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QDBusMessage>
+#include <QScreen>
+#include <QString>
+
+#include <netwm.h>
+
+#include "DBusCallQueue.hpp"
+#include "WindowSystemBackend.hpp"
+#include "X11WindowEnumerator.hpp"
+
+// Talks to the X server through KWindowSystem and xcb,
+// and to KWin's virtual desktop manager through D-Bus
+class KWinBackend : public WindowSystemBackend {
+    Q_OBJECT
+
+public:
+    KWinBackend(QObject* parent = nullptr);
+
+    int currentDesktop() const override;
+    int numberOfDesktops() const override;
+    QString desktopName(int number) const override;
+    QList<WId> windows() const override;
+    QList<WId> stackingOrder() const override;
+    QList<ScreenInfo> screens() const override;
+
+    bool fetchWindow(WId id, NET::Properties properties, WindowProperties& windowProperties) override;
+    QHash<WId, WindowProperties> fetchWindows(const QList<WId>& idList, NET::Properties properties) override;
+    WindowFetchFunction createWindowFetchFunction() override;
+
+    void setCurrentDesktop(int number) override;
+    void setNumberOfDesktops(int numberOfDesktops) override;
+    void setDesktopName(int number, const QString& name) override;
+    void commit(X11Batch& batch) override;
+
+    void fetchDesktops(DesktopListCallback callback) override;
+    void removeDesktop(const QString& id, ResultCallback callback) override;
+    void renameDesktop(const QString& id, const QString& name, ResultCallback callback) override;
+
+    void setStats(RefreshStats* stats) override;
+
+private slots:
+    void onDesktopCreated(const QDBusMessage& message);
+    void onDesktopRemoved(const QDBusMessage& message);
+    void onDesktopDataChanged(const QDBusMessage& message);
+    void onDesktopsChanged(const QDBusMessage& message);
+
+private:
+    QString dbusServiceName;
+    QString dbusPath;
+    QString dbusInterfaceName;
+
+    NETRootInfo netRootInfo;
+    X11WindowEnumerator windowEnumerator;
+    DBusCallQueue dbusCallQueue;
+
+    QDBusMessage createDBusMethodCall(const QString& method) const;
+    void connectToKWindowSystemSignals();
+    void connectToScreenSignals(QScreen* screen);
+    void connectToDBusSignals();
+};
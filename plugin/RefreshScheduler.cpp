@@ -0,0 +1,45 @@
+#include "RefreshScheduler.hpp"
+
+RefreshScheduler::RefreshScheduler(QObject* parent) : QObject(parent),
+        pendingChanges(NoChange),
+        suspendCount(0),
+        stats(nullptr) {
+
+    timer.setSingleShot(true);
+    timer.setInterval(0);
+
+    QObject::connect(&timer, &QTimer::timeout, this, [&] {
+        auto changes = pendingChanges;
+        pendingChanges = NoChange;
+        emit triggered(changes);
+    });
+}
+
+void RefreshScheduler::schedule(Changes changes) {
+    pendingChanges |= changes;
+    if (!timer.isActive() && suspendCount == 0) {
+        timer.start();
+    } else if (stats) {
+        stats->increment(RefreshStats::CoalescedChangeCounter);
+    }
+}
+
+void RefreshScheduler::suspend() {
+    if (suspendCount++ == 0) {
+        timer.stop();
+    }
+}
+
+void RefreshScheduler::resume() {
+    if (suspendCount > 0 && --suspendCount == 0 && pendingChanges) {
+        timer.start();
+    }
+}
+
+void RefreshScheduler::setInterval(int msec) {
+    timer.setInterval(qMax(0, msec));
+}
+
+void RefreshScheduler::setStats(RefreshStats* stats) {
+    this->stats = stats;
+}
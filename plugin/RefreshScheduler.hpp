@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+#include "RefreshStats.hpp"
+
+class RefreshScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    enum Change {
+        NoChange = 0,
+        DesktopCountChange = 1 << 0,
+        DesktopNamesChange = 1 << 1,
+        CurrentDesktopChange = 1 << 2,
+        WindowStateChange = 1 << 3,
+        ConfigurationChange = 1 << 4,
+        ScreenChange = 1 << 5
+    };
+    Q_DECLARE_FLAGS(Changes, Change)
+
+    RefreshScheduler(QObject* parent = nullptr);
+
+    // Accumulates changes, which are all processed in a single pass
+    // once the coalescing interval since the first of them elapses
+    void schedule(Changes changes);
+
+    // While suspended, changes are only accumulated,
+    // they are processed in a single pass after the last resume
+    void suspend();
+    void resume();
+
+    void setInterval(int msec);
+    void setStats(RefreshStats* stats);
+
+signals:
+    void triggered(RefreshScheduler::Changes changes);
+
+private:
+    QTimer timer;
+    Changes pendingChanges;
+    int suspendCount;
+    RefreshStats* stats;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(RefreshScheduler::Changes)
@@ -0,0 +1,195 @@
+#include "RefreshStats.hpp"
+
+#include <algorithm>
+
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(VIRTUAL_DESKTOP_BAR_STATS, "org.kde.plasma.virtualdesktopbar.stats", QtInfoMsg)
+
+RefreshStats::Timer::Timer(RefreshStats* stats, Stage stage) :
+        stats(stats),
+        stage(stage) {
+
+    if (stats) {
+        elapsedTimer.start();
+    }
+}
+
+RefreshStats::Timer::~Timer() {
+    if (stats) {
+        stats->addSample(stage, elapsedTimer.nsecsElapsed());
+    }
+}
+
+RefreshStats::RefreshStats(QObject* parent) : QObject(parent) {
+    startupTimer.start();
+    for (auto& startupPhase : startupPhaseList) {
+        startupPhase = -1;
+    }
+    reset();
+}
+
+void RefreshStats::addSample(Stage stage, qint64 nsecs) {
+    histogramList[stage].add(nsecs);
+}
+
+void RefreshStats::increment(Counter counter, int n) {
+    counterList[counter] += n;
+}
+
+void RefreshStats::markStartupPhase(StartupPhase phase) {
+    if (startupPhaseList[phase] < 0) {
+        startupPhaseList[phase] = startupTimer.nsecsElapsed();
+        emit changed();
+    }
+}
+
+QVariantMap RefreshStats::getSummary() const {
+    QVariantMap summary;
+
+    for (int i = 0; i < StageCount; i++) {
+        auto& histogram = histogramList[i];
+
+        // Durations are reported in microseconds, as they are mostly small
+        QVariantMap stageSummary;
+        stageSummary.insert("count", histogram.totalCount);
+        stageSummary.insert("p50", histogram.percentile(0.50) / 1000.0);
+        stageSummary.insert("p99", histogram.percentile(0.99) / 1000.0);
+        stageSummary.insert("max", histogram.percentile(1.00) / 1000.0);
+        summary.insert(getStageName(static_cast<Stage>(i)), stageSummary);
+    }
+
+    for (int i = 0; i < CounterCount; i++) {
+        summary.insert(getCounterName(static_cast<Counter>(i)), counterList[i]);
+    }
+
+    // Startup phases are reported in milliseconds, phases not reached yet are left out
+    QVariantMap startupSummary;
+    for (int i = 0; i < StartupPhaseCount; i++) {
+        if (startupPhaseList[i] >= 0) {
+            startupSummary.insert(getStartupPhaseName(static_cast<StartupPhase>(i)), startupPhaseList[i] / 1e6);
+        }
+    }
+    summary.insert("startup", startupSummary);
+
+    return summary;
+}
+
+void RefreshStats::dump() const {
+    for (int i = 0; i < StageCount; i++) {
+        auto& histogram = histogramList[i];
+        qCInfo(VIRTUAL_DESKTOP_BAR_STATS, "%-12s count %8lld  p50 %10.1f us  p99 %10.1f us  max %10.1f us",
+               getStageName(static_cast<Stage>(i)), histogram.totalCount,
+               histogram.percentile(0.50) / 1000.0,
+               histogram.percentile(0.99) / 1000.0,
+               histogram.percentile(1.00) / 1000.0);
+    }
+
+    for (int i = 0; i < CounterCount; i++) {
+        qCInfo(VIRTUAL_DESKTOP_BAR_STATS, "%-16s %lld",
+               getCounterName(static_cast<Counter>(i)), counterList[i]);
+    }
+
+    for (int i = 0; i < StartupPhaseCount; i++) {
+        if (startupPhaseList[i] >= 0) {
+            qCInfo(VIRTUAL_DESKTOP_BAR_STATS, "startup %-16s %10.2f ms",
+                   getStartupPhaseName(static_cast<StartupPhase>(i)), startupPhaseList[i] / 1e6);
+        }
+    }
+}
+
+void RefreshStats::reset() {
+    for (auto& histogram : histogramList) {
+        histogram = Histogram();
+    }
+    for (auto& counter : counterList) {
+        counter = 0;
+    }
+    emit changed();
+}
+
+void RefreshStats::notify() {
+    emit changed();
+}
+
+void RefreshStats::Histogram::add(qint64 nsecs) {
+    if (sampleList.length() < histogramSize) {
+        sampleList << nsecs;
+    } else {
+        sampleList[nextIndex] = nsecs;
+    }
+    nextIndex = (nextIndex + 1) % histogramSize;
+    totalCount++;
+}
+
+qint64 RefreshStats::Histogram::percentile(double p) const {
+    if (sampleList.isEmpty()) {
+        return 0;
+    }
+
+    // Sorting a copy only when asked, adding samples stays cheap
+    QVector<qint64> sortedSampleList = sampleList;
+    int n = qBound(0, int(p * (sortedSampleList.length() - 1) + 0.5), sortedSampleList.length() - 1);
+    std::nth_element(sortedSampleList.begin(), sortedSampleList.begin() + n, sortedSampleList.end());
+    return sortedSampleList[n];
+}
+
+const char* RefreshStats::getStageName(Stage stage) {
+    switch (stage) {
+        case RefreshStage:
+            return "refresh";
+        case WindowFetchStage:
+            return "windowFetch";
+        case TitleParseStage:
+            return "titleParse";
+        case WindowIndexStage:
+            return "windowIndex";
+        case DesktopListStage:
+            return "desktopList";
+        case ModelUpdateStage:
+            return "modelUpdate";
+        case DBusCallStage:
+            return "dbusCall";
+        case StageCount:
+            break;
+    }
+    return "";
+}
+
+const char* RefreshStats::getCounterName(Counter counter) {
+    switch (counter) {
+        case XRoundTripCounter:
+            return "xRoundTrips";
+        case DBusCallCounter:
+            return "dbusCalls";
+        case WindowScanCounter:
+            return "windowsScanned";
+        case RefreshCounter:
+            return "refreshes";
+        case CoalescedChangeCounter:
+            return "coalescedChanges";
+        case WindowEventCounter:
+            return "windowEvents";
+        case FilteredEventCounter:
+            return "filteredEvents";
+        case CounterCount:
+            break;
+    }
+    return "";
+}
+
+const char* RefreshStats::getStartupPhaseName(StartupPhase phase) {
+    switch (phase) {
+        case DesktopTablePhase:
+            return "desktopTable";
+        case FirstSnapshotPhase:
+            return "firstSnapshot";
+        case WindowScanPhase:
+            return "windowScan";
+        case ShortcutsPhase:
+            return "shortcuts";
+        case StartupPhaseCount:
+            break;
+    }
+    return "";
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVariantMap>
+#include <QVector>
+
+class RefreshStats : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(QVariantMap summary READ getSummary NOTIFY changed)
+
+public:
+    enum Stage {
+        RefreshStage,
+        WindowFetchStage,
+        TitleParseStage,
+        WindowIndexStage,
+        DesktopListStage,
+        ModelUpdateStage,
+        DBusCallStage,
+        StageCount
+    };
+
+    enum Counter {
+        XRoundTripCounter,
+        DBusCallCounter,
+        WindowScanCounter,
+        RefreshCounter,
+        CoalescedChangeCounter,
+        WindowEventCounter,
+        FilteredEventCounter,
+        CounterCount
+    };
+
+    // Points of the core's startup, in the order they are usually reached in
+    enum StartupPhase {
+        DesktopTablePhase,
+        FirstSnapshotPhase,
+        WindowScanPhase,
+        ShortcutsPhase,
+        StartupPhaseCount
+    };
+
+    // Measures the time between its construction and destruction,
+    // does nothing if there are no stats to record it in
+    class Timer {
+    public:
+        Timer(RefreshStats* stats, Stage stage);
+        ~Timer();
+
+    private:
+        RefreshStats* stats;
+        Stage stage;
+        QElapsedTimer elapsedTimer;
+    };
+
+    RefreshStats(QObject* parent = nullptr);
+
+    void addSample(Stage stage, qint64 nsecs);
+    void increment(Counter counter, int n = 1);
+
+    // Records the time since the stats were created, only the first time
+    // each phase is reached. Phases are kept across resets
+    void markStartupPhase(StartupPhase phase);
+
+    QVariantMap getSummary() const;
+
+    Q_INVOKABLE void dump() const;
+    Q_INVOKABLE void reset();
+
+    // Lets QML know that new samples are there,
+    // called once per refresh instead of once per sample
+    void notify();
+
+signals:
+    void changed();
+
+private:
+    // Rolling window of the most recent samples, in nanoseconds
+    class Histogram {
+    public:
+        QVector<qint64> sampleList;
+        int nextIndex = 0;
+        qint64 totalCount = 0;
+
+        void add(qint64 nsecs);
+        qint64 percentile(double p) const;
+    };
+
+    static const int histogramSize = 512;
+
+    Histogram histogramList[StageCount];
+    qint64 counterList[CounterCount];
+
+    QElapsedTimer startupTimer;
+    qint64 startupPhaseList[StartupPhaseCount];
+
+    static const char* getStageName(Stage stage);
+    static const char* getCounterName(Counter counter);
+    static const char* getStartupPhaseName(StartupPhase phase);
+};
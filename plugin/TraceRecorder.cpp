@@ -0,0 +1,298 @@
+#include "TraceRecorder.hpp"
+
+#include <QJsonDocument>
+#include <QLoggingCategory>
+
+#include "WindowCache.hpp"
+
+Q_LOGGING_CATEGORY(VIRTUAL_DESKTOP_BAR_TRACE, "org.kde.plasma.virtualdesktopbar.trace", QtInfoMsg)
+
+TraceRecorder::TraceRecorder(WindowSystemBackend* backend, const QString& path, QObject* parent) : QObject(parent),
+        backend(backend),
+        file(path) {
+
+    // Unbuffered, so the trace is complete even if the shell crashes
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        qCWarning(VIRTUAL_DESKTOP_BAR_TRACE, "Cannot record a trace to %s: %s",
+                  qPrintable(path), qPrintable(file.errorString()));
+        return;
+    }
+
+    clock.start();
+    writeState();
+    setUpSignals();
+}
+
+void TraceRecorder::setUpSignals() {
+    QObject::connect(backend, &WindowSystemBackend::currentDesktopChanged, this, [&](int number) {
+        QJsonObject object;
+        object.insert("number", number);
+        write("currentDesktop", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::numberOfDesktopsChanged, this, [&](int numberOfDesktops) {
+        QJsonObject object;
+        object.insert("count", numberOfDesktops);
+        write("desktopCount", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopNamesChanged, this, [&] {
+        QJsonObject object;
+        object.insert("names", getDesktopNames());
+        write("desktopNames", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::windowAdded, this, [&](WId id) {
+        WindowProperties windowProperties;
+        if (!backend->fetchWindow(id, WindowCache::cachedProperties, windowProperties)) {
+            return;
+        }
+
+        QJsonObject object;
+        object.insert("window", windowToJson(id, windowProperties, WindowCache::cachedProperties));
+        write("windowAdded", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::windowRemoved, this, [&](WId id) {
+        QJsonObject object;
+        object.insert("id", double(id));
+        write("windowRemoved", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::windowChanged, this, [&](WId id, NET::Properties properties, NET::Properties2 properties2) {
+        // Changes the applet does not look at are recorded without values
+        auto fetchedProperties = WindowCache::getFetchedProperties(properties);
+        WindowProperties windowProperties;
+        if (fetchedProperties && !backend->fetchWindow(id, fetchedProperties, windowProperties)) {
+            fetchedProperties = NET::Properties();
+        }
+
+        QJsonObject object;
+        object.insert("properties", int(properties));
+        object.insert("properties2", int(properties2));
+        object.insert("window", windowToJson(id, windowProperties, fetchedProperties));
+        write("windowChanged", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::stackingOrderChanged, this, [&] {
+        QJsonObject object;
+        object.insert("ids", idsToJson(backend->stackingOrder()));
+        write("stackingOrder", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::screensChanged, this, [&] {
+        QJsonObject object;
+        object.insert("screens", screensToJson(backend->screens()));
+        write("screens", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopCreated, this, [&](const DesktopInfo& desktopInfo) {
+        QJsonObject object;
+        object.insert("desktop", desktopToJson(desktopInfo));
+        write("desktopCreated", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopRemoved, this, [&](const QString& id) {
+        QJsonObject object;
+        object.insert("id", id);
+        write("desktopRemoved", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopDataChanged, this, [&](const DesktopInfo& desktopInfo) {
+        QJsonObject object;
+        object.insert("desktop", desktopToJson(desktopInfo));
+        write("desktopDataChanged", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopsChanged, this, [&](const QList<DesktopInfo>& desktopInfoList) {
+        QJsonObject object;
+        object.insert("desktops", desktopsToJson(desktopInfoList));
+        write("desktopsChanged", object);
+    });
+
+    // Results are replayed in the order of the requests, which KWin answers in turn
+    QObject::connect(backend, &WindowSystemBackend::desktopsFetched, this, [&](bool isValid, const QList<DesktopInfo>& desktopInfoList) {
+        QJsonObject object;
+        object.insert("valid", isValid);
+        object.insert("desktops", desktopsToJson(desktopInfoList));
+        write("desktopsFetched", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopRemoveFinished, this, [&](const QString& id, bool isSuccessful) {
+        QJsonObject object;
+        object.insert("id", id);
+        object.insert("successful", isSuccessful);
+        write("desktopRemoveFinished", object);
+    });
+
+    QObject::connect(backend, &WindowSystemBackend::desktopRenameFinished, this, [&](const QString& id, const QString& name, bool isSuccessful) {
+        QJsonObject object;
+        object.insert("id", id);
+        object.insert("name", name);
+        object.insert("successful", isSuccessful);
+        write("desktopRenameFinished", object);
+    });
+}
+
+QJsonObject TraceRecorder::windowToJson(WId id, const WindowProperties& windowProperties, NET::Properties properties) {
+    QJsonObject object;
+    object.insert("id", double(id));
+
+    if (properties & NET::WMState) {
+        object.insert("state", int(windowProperties.state));
+    }
+    if (properties & NET::WMDesktop) {
+        object.insert("desktop", windowProperties.desktopNumber);
+    }
+    if (properties & NET::WMGeometry) {
+        auto& geometry = windowProperties.geometry;
+        object.insert("geometry", QJsonArray({ geometry.x(), geometry.y(), geometry.width(), geometry.height() }));
+    }
+    if (properties & NET::WMWindowType) {
+        object.insert("type", int(windowProperties.windowType));
+    }
+    if (properties & NET::WMName) {
+        object.insert("name", windowProperties.name);
+    }
+
+    return object;
+}
+
+NET::Properties TraceRecorder::windowFromJson(const QJsonObject& object, WId& id, WindowProperties& windowProperties) {
+    NET::Properties properties;
+    id = WId(object.value("id").toDouble());
+
+    if (object.contains("state")) {
+        windowProperties.state = NET::States(object.value("state").toInt());
+        properties |= NET::WMState;
+    }
+    if (object.contains("desktop")) {
+        windowProperties.desktopNumber = object.value("desktop").toInt();
+        properties |= NET::WMDesktop;
+    }
+    if (object.contains("geometry")) {
+        auto geometry = object.value("geometry").toArray();
+        windowProperties.geometry = QRect(geometry.at(0).toInt(), geometry.at(1).toInt(),
+                                          geometry.at(2).toInt(), geometry.at(3).toInt());
+        properties |= NET::WMGeometry;
+    }
+    if (object.contains("type")) {
+        windowProperties.windowType = NET::WindowType(object.value("type").toInt());
+        properties |= NET::WMWindowType;
+    }
+    if (object.contains("name")) {
+        windowProperties.name = object.value("name").toString();
+        properties |= NET::WMName;
+    }
+
+    return properties;
+}
+
+QJsonArray TraceRecorder::screensToJson(const QList<ScreenInfo>& screenInfoList) {
+    QJsonArray array;
+    for (auto& screenInfo : screenInfoList) {
+        auto& geometry = screenInfo.geometry;
+        QJsonObject object;
+        object.insert("name", screenInfo.name);
+        object.insert("geometry", QJsonArray({ geometry.x(), geometry.y(), geometry.width(), geometry.height() }));
+        array << object;
+    }
+    return array;
+}
+
+QList<ScreenInfo> TraceRecorder::screensFromJson(const QJsonArray& array) {
+    QList<ScreenInfo> screenInfoList;
+    for (auto value : array) {
+        auto object = value.toObject();
+        auto geometry = object.value("geometry").toArray();
+
+        ScreenInfo screenInfo;
+        screenInfo.name = object.value("name").toString();
+        screenInfo.geometry = QRect(geometry.at(0).toInt(), geometry.at(1).toInt(),
+                                    geometry.at(2).toInt(), geometry.at(3).toInt());
+        screenInfoList << screenInfo;
+    }
+    return screenInfoList;
+}
+
+QJsonArray TraceRecorder::desktopsToJson(const QList<DesktopInfo>& desktopInfoList) {
+    QJsonArray array;
+    for (auto& desktopInfo : desktopInfoList) {
+        array << desktopToJson(desktopInfo);
+    }
+    return array;
+}
+
+QList<DesktopInfo> TraceRecorder::desktopsFromJson(const QJsonArray& array) {
+    QList<DesktopInfo> desktopInfoList;
+    for (auto value : array) {
+        desktopInfoList << desktopFromJson(value.toObject());
+    }
+    return desktopInfoList;
+}
+
+QJsonObject TraceRecorder::desktopToJson(const DesktopInfo& desktopInfo) {
+    QJsonObject object;
+    object.insert("number", desktopInfo.number);
+    object.insert("id", desktopInfo.id);
+    object.insert("name", desktopInfo.name);
+    return object;
+}
+
+DesktopInfo TraceRecorder::desktopFromJson(const QJsonObject& object) {
+    DesktopInfo desktopInfo;
+    desktopInfo.number = object.value("number").toInt();
+    desktopInfo.id = object.value("id").toString();
+    desktopInfo.name = object.value("name").toString();
+    return desktopInfo;
+}
+
+QJsonArray TraceRecorder::idsToJson(const QList<WId>& idList) {
+    QJsonArray array;
+    for (WId id : idList) {
+        array << double(id);
+    }
+    return array;
+}
+
+QList<WId> TraceRecorder::idsFromJson(const QJsonArray& array) {
+    QList<WId> idList;
+    for (auto value : array) {
+        idList << WId(value.toDouble());
+    }
+    return idList;
+}
+
+QJsonArray TraceRecorder::getDesktopNames() const {
+    QJsonArray array;
+    for (int i = 1; i <= backend->numberOfDesktops(); i++) {
+        array << backend->desktopName(i);
+    }
+    return array;
+}
+
+void TraceRecorder::writeState() {
+    auto windowPropertiesHash = backend->fetchWindows(backend->windows(), WindowCache::cachedProperties);
+
+    QJsonArray windowArray;
+    for (auto it = windowPropertiesHash.constBegin(); it != windowPropertiesHash.constEnd(); it++) {
+        windowArray << windowToJson(it.key(), it.value(), WindowCache::cachedProperties);
+    }
+
+    QJsonObject object;
+    object.insert("currentDesktop", backend->currentDesktop());
+    object.insert("names", getDesktopNames());
+    object.insert("screens", screensToJson(backend->screens()));
+    object.insert("windows", windowArray);
+    object.insert("ids", idsToJson(backend->stackingOrder()));
+    write("state", object);
+}
+
+void TraceRecorder::write(const QString& event, QJsonObject object) {
+    // Times are in milliseconds since recording started, to the microsecond
+    object.insert("time", clock.nsecsElapsed() / 1000 / 1000.0);
+    object.insert("event", event);
+
+    file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    file.write("\n");
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "WindowSystemBackend.hpp"
+
+// Records everything the window system and the desktop manager report through
+// the backend, including the results of requests, to a file with one JSON
+// object per line, starting with the state at the time, so event storms seen
+// in a real session can be replayed offline. Changed windows are
+// fetched once more for the trace, so recording is only meant for diagnosis
+class TraceRecorder : public QObject {
+    Q_OBJECT
+
+public:
+    TraceRecorder(WindowSystemBackend* backend, const QString& path, QObject* parent = nullptr);
+
+    // Windows as written to and read from traces, with only the given
+    // properties, reading returns the properties which were there
+    static QJsonObject windowToJson(WId id, const WindowProperties& windowProperties, NET::Properties properties);
+    static NET::Properties windowFromJson(const QJsonObject& object, WId& id, WindowProperties& windowProperties);
+
+    static QJsonArray screensToJson(const QList<ScreenInfo>& screenInfoList);
+    static QList<ScreenInfo> screensFromJson(const QJsonArray& array);
+
+    static QJsonArray desktopsToJson(const QList<DesktopInfo>& desktopInfoList);
+    static QList<DesktopInfo> desktopsFromJson(const QJsonArray& array);
+    static QJsonObject desktopToJson(const DesktopInfo& desktopInfo);
+    static DesktopInfo desktopFromJson(const QJsonObject& object);
+
+    static QJsonArray idsToJson(const QList<WId>& idList);
+    static QList<WId> idsFromJson(const QJsonArray& array);
+
+private:
+    WindowSystemBackend* backend;
+    QFile file;
+    QElapsedTimer clock;
+
+    QJsonArray getDesktopNames() const;
+
+    void setUpSignals();
+    void writeState();
+    void write(const QString& event, QJsonObject object = QJsonObject());
+};
@@ -1,447 +1,229 @@
 #include "VirtualDesktopBar.hpp"
 
-#include <functional>
-
-#include <QGuiApplication>
-#include <QRegularExpression>
-#include <QScreen>
-#include <QTimer>
-#include <QX11Info>
-
-#include <KGlobalAccel>
-
-VirtualDesktopBar::VirtualDesktopBar(QObject* parent) : QObject(parent),
-        netRootInfo(QX11Info::connection(), 0),
-        dbusInterface("org.kde.KWin", "/VirtualDesktopManager"),
-        dbusInterfaceName("org.kde.KWin.VirtualDesktopManager"),
-        sendDesktopInfoListLock(false),
-        tryAddEmptyDesktopLock(false),
-        tryRemoveEmptyDesktopsLock(false),
-        tryRenameEmptyDesktopsLock(false),
-        currentDesktopNumber(KWindowSystem::currentDesktop()),
-        mostRecentDesktopNumber(currentDesktopNumber) {
-
+#include <utility>
+
+VirtualDesktopBar::VirtualDesktopBar(QObject* parent) : VirtualDesktopBar(DesktopBarCore::acquire(), parent) {}
+
+VirtualDesktopBar::VirtualDesktopBar(QSharedPointer<DesktopBarCore> core, QObject* parent) : QObject(parent),
+        core(core),
+        windowNamesShown(false),
+        cfg_DynamicDesktopsEnable(false),
+        cfg_DynamicDesktopsRemovalDelay(0),
+        cfg_DynamicDesktopsMinimumInterval(0),
+        cfg_MultipleScreensFilterOccupiedDesktops(false),
+        cfg_PerformanceCoalescingInterval(0),
+        cfg_AnimationsEnable(false),
+        desktopListModel(new DesktopListModel(this)) {
+
+    updateSettings();
     setUpSignals();
-    setUpGlobalKeyboardShortcuts();
+}
+
+VirtualDesktopBar::~VirtualDesktopBar() {
+    core->removeSettings(this);
 }
 
 void VirtualDesktopBar::requestDesktopInfoList() {
     sendDesktopInfoList();
 }
 
+DesktopListModel* VirtualDesktopBar::getDesktopListModel() const {
+    return desktopListModel;
+}
+
+RefreshStats* VirtualDesktopBar::getStats() const {
+    return core->getStats();
+}
+
 void VirtualDesktopBar::showDesktop(int number) {
-    KWindowSystem::setCurrentDesktop(number);
+    core->showDesktop(number);
 }
 
 void VirtualDesktopBar::addDesktop(unsigned /*position*/) {
-    netRootInfo.setNumberOfDesktops(KWindowSystem::numberOfDesktops() + 1);
-
-    if (!cfg_AddingDesktopsExecuteCommand.isEmpty()) {
-        QTimer::singleShot(100, [=] {
-            QString command = "(" + cfg_AddingDesktopsExecuteCommand + ") &";
-            system(command.toStdString().c_str());
-        });
-    }
+    core->addDesktop();
 }
 
 void VirtualDesktopBar::removeDesktop(int number) {
-    auto reply = dbusInterface.call("removeDesktop", getDesktopInfo(number).id);
-
-    if (reply.type() == QDBusMessage::ErrorMessage) {
-        if (number == KWindowSystem::numberOfDesktops()) {
-            netRootInfo.setNumberOfDesktops(KWindowSystem::numberOfDesktops() - 1);
-        } else {
-            tryAddEmptyDesktopLock = true;
-            tryRemoveEmptyDesktopsLock = true;
-            tryRenameEmptyDesktopsLock = true;
-            sendDesktopInfoListLock = true;
-
-            QList<QString> desktopNameList;
-            QList<KWindowInfo> windowInfoList;
-            for (int i = number + 1; i <= KWindowSystem::numberOfDesktops(); i++) {
-                desktopNameList << KWindowSystem::desktopName(i);
-                windowInfoList.append(getWindowInfoList(i));
-            }
-
-            for (int i = number, j = 0; i <= KWindowSystem::numberOfDesktops() - 1; i++, j++) {
-                renameDesktop(i, desktopNameList[j]);
-            }
-
-            for (auto& windowInfo : windowInfoList) {
-                KWindowSystem::setOnDesktop(windowInfo.win(), windowInfo.desktop() - 1);
-            }
-
-            tryAddEmptyDesktopLock = false;
-            tryRemoveEmptyDesktopsLock = false;
-            tryRenameEmptyDesktopsLock = false;
-            sendDesktopInfoListLock = false;
+    core->removeDesktops({ number });
+}
 
-            netRootInfo.setNumberOfDesktops(KWindowSystem::numberOfDesktops() - 1);
-        }
-    }
+void VirtualDesktopBar::removeDesktops(QList<int> numbers) {
+    core->removeDesktops(numbers);
 }
 
 void VirtualDesktopBar::renameDesktop(int number, QString name) {
-    auto reply = dbusInterface.call("setDesktopName", getDesktopInfo(number).id, name);
-
-    if (reply.type() == QDBusMessage::ErrorMessage) {
-        KWindowSystem::setDesktopName(number, name);
-    }
+    core->renameDesktop(number, name);
 }
 
 void VirtualDesktopBar::replaceDesktops(int number1, int number2) {
+    int numberOfDesktops = core->getDesktopTable().count();
     if (number1 == number2) {
         return;
     }
-    if (number1 < 1 || number1 > KWindowSystem::numberOfDesktops()) {
+    if (number1 < 1 || number1 > numberOfDesktops) {
         return;
     }
-    if (number2 < 1 || number2 > KWindowSystem::numberOfDesktops()) {
+    if (number2 < 1 || number2 > numberOfDesktops) {
         return;
     }
 
-    auto desktopInfo1 = getDesktopInfo(number1);
-    auto desktopInfo2 = getDesktopInfo(number2);
-
-    auto windowInfoList1 = getWindowInfoList(desktopInfo1.number);
-    auto windowInfoList2 = getWindowInfoList(desktopInfo2.number);
-
-    if (desktopInfo1.isCurrent) {
-        KWindowSystem::setCurrentDesktop(desktopInfo2.number);
-    } else if (desktopInfo2.isCurrent) {
-        KWindowSystem::setCurrentDesktop(desktopInfo1.number);
-    }
-
-    for (auto& windowInfo : windowInfoList2) {
-        KWindowSystem::setOnDesktop(windowInfo.win(), desktopInfo1.number);
-    }
-
-    for (auto& windowInfo : windowInfoList1) {
-        KWindowSystem::setOnDesktop(windowInfo.win(), desktopInfo2.number);
+    QList<int> permutation;
+    for (int i = 1; i <= numberOfDesktops; i++) {
+        permutation << i;
     }
+    qSwap(permutation[number1 - 1], permutation[number2 - 1]);
 
-    renameDesktop(desktopInfo1.number, desktopInfo2.name);
-    renameDesktop(desktopInfo2.number, desktopInfo1.name);
+    core->applyPermutation(permutation);
 }
 
-void VirtualDesktopBar::setUpSignals() {
-    setUpKWinSignals();
-    setUpInternalSignals();
+void VirtualDesktopBar::moveDesktop(int from, int to) {
+    core->moveDesktop(from, to);
 }
 
-void VirtualDesktopBar::setUpKWinSignals() {
-    QObject::connect(KWindowSystem::self(), &KWindowSystem::currentDesktopChanged, this, [&] {
-        updateLocalDesktopNumbers();
-        processChanges([&] { sendDesktopInfoList(); }, sendDesktopInfoListLock);
-    });
-
-    QObject::connect(KWindowSystem::self(), &KWindowSystem::numberOfDesktopsChanged, this, [&] {
-        processChanges([&] { tryAddEmptyDesktop(); }, tryAddEmptyDesktopLock);
-        processChanges([&] { tryRemoveEmptyDesktops(); }, tryRemoveEmptyDesktopsLock);
-        processChanges([&] { tryRenameEmptyDesktops(); }, tryRenameEmptyDesktopsLock);
-        processChanges([&] { sendDesktopInfoList(); }, sendDesktopInfoListLock);
-    });
+void VirtualDesktopBar::applyPermutation(QList<int> permutation) {
+    core->applyPermutation(permutation);
+}
 
-    QObject::connect(KWindowSystem::self(), &KWindowSystem::desktopNamesChanged, this, [&] {
-        processChanges([&] { sendDesktopInfoList(); }, sendDesktopInfoListLock);
+void VirtualDesktopBar::setUpSignals() {
+    QObject::connect(core.data(), &DesktopBarCore::refreshed, this, [&] {
+        sendDesktopInfoList();
     });
 
-    QObject::connect(KWindowSystem::self(), static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>
-                                            (&KWindowSystem::windowChanged), this, [&](WId, NET::Properties properties, NET::Properties2) {
-        if (properties & NET::WMState) {
-            processChanges([&] { tryAddEmptyDesktop(); }, tryAddEmptyDesktopLock);
-            processChanges([&] { tryRemoveEmptyDesktops(); }, tryRemoveEmptyDesktopsLock);
-            processChanges([&] { tryRenameEmptyDesktops(); }, tryRenameEmptyDesktopsLock);
-            processChanges([&] { sendDesktopInfoList(); }, sendDesktopInfoListLock);
+    QObject::connect(core.data(), &DesktopBarCore::requestRenameCurrentDesktop, this, [&] {
+        if (core->isPrimaryView(this)) {
+            emit requestRenameCurrentDesktop();
         }
     });
-}
-
-void VirtualDesktopBar::setUpInternalSignals() {
-    QObject::connect(this, &VirtualDesktopBar::cfg_EmptyDesktopsRenameAsChanged, this, [&] {
-        tryRenameEmptyDesktops();
-    });
 
-    QObject::connect(this, &VirtualDesktopBar::cfg_DynamicDesktopsEnableChanged, this, [&] {
-        tryAddEmptyDesktop();
-        tryRemoveEmptyDesktops();
+    // Only this instance shows the screen it is on and filters by it,
+    // a refresh of the core brings it up to date
+    QObject::connect(this, &VirtualDesktopBar::screenNameChanged, this, [&] {
+        core->schedule(RefreshScheduler::ScreenChange);
     });
 
     QObject::connect(this, &VirtualDesktopBar::cfg_MultipleScreensFilterOccupiedDesktopsChanged, this, [&] {
-        sendDesktopInfoList();
+        updateSettings();
+        core->schedule(RefreshScheduler::ScreenChange);
     });
-}
-
-void VirtualDesktopBar::setUpGlobalKeyboardShortcuts() {
-    QString prefix = "Virtual Desktop Bar - ";
-    actionCollection = new KActionCollection(this, QStringLiteral("kwin"));
 
-    actionSwitchToRecentDesktop = actionCollection->addAction(QStringLiteral("switchToRecentDesktop"));
-    actionSwitchToRecentDesktop->setText(prefix + "Switch to Recent Desktop");
-    QObject::connect(actionSwitchToRecentDesktop, &QAction::triggered, this, [&] {
-        showDesktop(mostRecentDesktopNumber);
+    QObject::connect(this, &VirtualDesktopBar::windowNamesShownChanged, this, [&] {
+        updateSettings();
     });
-    KGlobalAccel::setGlobalShortcut(actionSwitchToRecentDesktop, QKeySequence());
 
-    actionAddDesktop = actionCollection->addAction(QStringLiteral("addDesktop"));
-    actionAddDesktop->setText(prefix + "Add Desktop");
-    QObject::connect(actionAddDesktop, &QAction::triggered, this, [&] {
-        if (!cfg_DynamicDesktopsEnable) {
-            addDesktop();
-        }
+    QObject::connect(this, &VirtualDesktopBar::cfg_EmptyDesktopsRenameAsChanged, this, [&] {
+        updateSettings();
     });
-    KGlobalAccel::setGlobalShortcut(actionAddDesktop, QKeySequence());
 
-    actionRemoveLastDesktop = actionCollection->addAction(QStringLiteral("removeLastDesktop"));
-    actionRemoveLastDesktop->setText(prefix + "Remove Last Desktop");
-    QObject::connect(actionRemoveLastDesktop, &QAction::triggered, this, [&] {
-        if (!cfg_DynamicDesktopsEnable) {
-            removeDesktop(KWindowSystem::numberOfDesktops());
-        }
+    QObject::connect(this, &VirtualDesktopBar::cfg_AddingDesktopsExecuteCommandChanged, this, [&] {
+        updateSettings();
     });
-    KGlobalAccel::setGlobalShortcut(actionRemoveLastDesktop, QKeySequence());
 
-    actionRemoveCurrentDesktop = actionCollection->addAction(QStringLiteral("removeCurrentDesktop"));
-    actionRemoveCurrentDesktop->setText(prefix + "Remove Current Desktop");
-    QObject::connect(actionRemoveCurrentDesktop, &QAction::triggered, this, [&] {
-        if (!cfg_DynamicDesktopsEnable) {
-            removeDesktop(KWindowSystem::currentDesktop());
-        }
+    QObject::connect(this, &VirtualDesktopBar::cfg_DesktopLabelsWindowNameRulesChanged, this, [&] {
+        updateSettings();
     });
-    KGlobalAccel::setGlobalShortcut(actionRemoveCurrentDesktop, QKeySequence());
 
-    actionRenameCurrentDesktop = actionCollection->addAction(QStringLiteral("renameCurrentDesktop"));
-    actionRenameCurrentDesktop->setText(prefix + "Rename Current Desktop");
-    QObject::connect(actionRenameCurrentDesktop, &QAction::triggered, this, [&] {
-        emit requestRenameCurrentDesktop();
+    QObject::connect(this, &VirtualDesktopBar::cfg_DynamicDesktopsEnableChanged, this, [&] {
+        updateSettings();
     });
-    KGlobalAccel::setGlobalShortcut(actionRenameCurrentDesktop, QKeySequence());
 
-    actionMoveCurrentDesktopToLeft = actionCollection->addAction(QStringLiteral("moveCurrentDesktopToLeft"));
-    actionMoveCurrentDesktopToLeft->setText(prefix + "Move Current Desktop to Left");
-    QObject::connect(actionMoveCurrentDesktopToLeft, &QAction::triggered, this, [&] {
-        replaceDesktops(KWindowSystem::currentDesktop(),
-                        KWindowSystem::currentDesktop() - 1);
+    QObject::connect(this, &VirtualDesktopBar::cfg_DynamicDesktopsRemovalDelayChanged, this, [&] {
+        updateSettings();
     });
-    KGlobalAccel::setGlobalShortcut(actionMoveCurrentDesktopToLeft, QKeySequence());
 
-    actionMoveCurrentDesktopToRight = actionCollection->addAction(QStringLiteral("moveCurrentDesktopToRight"));
-    actionMoveCurrentDesktopToRight->setText(prefix + "Move Current Desktop to Right");
-    QObject::connect(actionMoveCurrentDesktopToRight, &QAction::triggered, this, [&] {
-        replaceDesktops(KWindowSystem::currentDesktop(),
-                        KWindowSystem::currentDesktop() + 1);
+    QObject::connect(this, &VirtualDesktopBar::cfg_DynamicDesktopsMinimumIntervalChanged, this, [&] {
+        updateSettings();
     });
-    KGlobalAccel::setGlobalShortcut(actionMoveCurrentDesktopToRight, QKeySequence());
-}
 
-void VirtualDesktopBar::processChanges(std::function<void()> callback, bool& lock) {
-    if (!lock) {
-        lock = true;
-        QTimer::singleShot(1, [this, callback, &lock] {
-            lock = false;
-            callback();
-        });
-    }
-}
+    QObject::connect(this, &VirtualDesktopBar::cfg_PerformanceCoalescingIntervalChanged, this, [&] {
+        updateSettings();
+    });
 
-DesktopInfo VirtualDesktopBar::getDesktopInfo(int number) {
-    for (auto& desktopInfo : getDesktopInfoList()) {
-        if (desktopInfo.number == number) {
-            return desktopInfo;
-        }
-    }
-    return DesktopInfo();
+    // Removed desktops are kept in the model while their buttons fade out
+    QObject::connect(this, &VirtualDesktopBar::cfg_AnimationsEnableChanged, this, [&] {
+        desktopListModel->setRemovalDeferred(cfg_AnimationsEnable);
+    });
 }
 
-DesktopInfo VirtualDesktopBar::getDesktopInfo(QString id) {
-    for (auto& desktopInfo : getDesktopInfoList()) {
-        if (desktopInfo.id == id) {
-            return desktopInfo;
-        }
-    }
-    return DesktopInfo();
+void VirtualDesktopBar::updateSettings() {
+    DesktopBarCore::Settings settings;
+    settings.emptyDesktopsRenameAs = cfg_EmptyDesktopsRenameAs;
+    settings.addingDesktopsExecuteCommand = cfg_AddingDesktopsExecuteCommand;
+    settings.windowNameRules = cfg_DesktopLabelsWindowNameRules;
+    settings.dynamicDesktopsEnable = cfg_DynamicDesktopsEnable;
+    settings.dynamicDesktopsRemovalDelay = cfg_DynamicDesktopsRemovalDelay;
+    settings.dynamicDesktopsMinimumInterval = cfg_DynamicDesktopsMinimumInterval;
+    settings.windowNamesShow = windowNamesShown;
+    settings.screenFilterEnable = cfg_MultipleScreensFilterOccupiedDesktops;
+    settings.coalescingInterval = cfg_PerformanceCoalescingInterval;
+    core->setSettings(this, settings);
 }
 
-QList<DesktopInfo> VirtualDesktopBar::getDesktopInfoList(bool extraInfo) {
-    QList<DesktopInfo> desktopInfoList;
+DesktopSnapshot VirtualDesktopBar::buildDesktopSnapshot() {
+    RefreshStats::Timer timer(core->getStats(), RefreshStats::DesktopListStage);
 
-    // Getting info about desktops through the KWin's D-Bus service here
-    auto reply = dbusInterface.call("Get", dbusInterfaceName, "desktops");
+    auto& desktopInfoList = core->getDesktopTable().getDesktopInfoList();
+    auto& index = core->getWindowIndex();
+    int screenIndex = core->getScreenIndex(screenName);
+    int currentDesktop = core->getBackend()->currentDesktop();
+    bool isFiltered = cfg_MultipleScreensFilterOccupiedDesktops;
 
-    if (reply.type() == QDBusMessage::ErrorMessage) {
-        for (int i = 1; i <= KWindowSystem::numberOfDesktops(); i++) {
-            DesktopInfo desktopInfo;
-            desktopInfo.id = i;
-            desktopInfo.number = i;
-            desktopInfo.name = KWindowSystem::desktopName(i);
-
-            desktopInfoList << desktopInfo;
-        }
-    } else {
-        // Extracting data from the D-Bus reply message here
-        // More details at https://stackoverflow.com/a/20206377
-        auto something = reply.arguments().at(0).value<QDBusVariant>();
-        auto somethingSomething = something.variant().value<QDBusArgument>();
-        somethingSomething >> desktopInfoList;
-    }
+    DesktopSnapshot::Builder builder(desktopInfoList.length());
 
     for (auto& desktopInfo : desktopInfoList) {
-        desktopInfo.isCurrent = desktopInfo.number == KWindowSystem::currentDesktop();
-
-        if (!extraInfo) {
-            continue;
-        }
-
-        auto windowInfoList = getWindowInfoList(desktopInfo.number);
-
-        desktopInfo.isEmpty = windowInfoList.isEmpty();
-
-        for (int i = 0; i < windowInfoList.length(); i++) {
-            auto& windowInfo = windowInfoList[i];
-
-            if (!desktopInfo.isUrgent) {
-                desktopInfo.isUrgent = windowInfo.hasState(NET::DemandsAttention);
-            }
-
-            QString windowName = windowInfo.name();
-            int separatorPosition = qMax(windowName.lastIndexOf(" - "),
-                                         qMax(windowName.lastIndexOf(" – "),
-                                              windowName.lastIndexOf(" — ")));
-            if (separatorPosition >= 0) {
-                separatorPosition += 3;
-                int length = windowName.length() - separatorPosition;
-                QStringRef substringRef(&windowName, separatorPosition, length);
-                windowName = substringRef.toString().trimmed();
-            }
-
-            if (i == 0) {
-                desktopInfo.activeWindowName = windowName;
-            }
-
-            desktopInfo.windowNameList << windowName;
-        }
-    }
-
-    return desktopInfoList;
-}
-
-QList<KWindowInfo> VirtualDesktopBar::getWindowInfoList(int desktopNumber, bool ignoreScreens) {
-    QList<KWindowInfo> windowInfoList;
-
-    auto screenRect = QGuiApplication::screens().at(0)->geometry();
-
-    QList<WId> windowIds = KWindowSystem::stackingOrder();
-    for (int i = windowIds.length() - 1; i >= 0; i--) {
-        KWindowInfo windowInfo(windowIds[i], NET::WMState |
-                                             NET::WMDesktop |
-                                             NET::WMGeometry |
-                                             NET::WMWindowType |
-                                             NET::WMName);
+        int number = desktopInfo.number;
+        builder.append(number, desktopInfo.id, desktopInfo.name);
 
-        // Skipping windows not present on the current desktops
-        if (windowInfo.desktop() != desktopNumber &&
-            windowInfo.desktop() != -1) {
-            continue;
+        if (number == currentDesktop) {
+            builder.setCurrent();
         }
 
-        // Skipping some flagged windows
-        if (windowInfo.hasState(NET::SkipPager) ||
-            windowInfo.hasState(NET::SkipTaskbar)) {
+        // Only the summary is sent, the window names are fetched
+        // on demand with getWindowNameList when a tooltip is shown
+        int windowCount = isFiltered ? index.count(number, screenIndex) : index.count(number);
+        if (windowCount == 0) {
             continue;
         }
 
-        auto windowType = windowInfo.windowType(NET::AllTypesMask);
-        if (windowType != -1 &&
-            ((windowType == NET::Dock) ||
-             (windowType == NET::Desktop))) {
-            continue;
-        }
+        bool isUrgent = isFiltered ? index.isUrgent(number, screenIndex) : index.isUrgent(number);
 
-        // Skipping windows not present on the current screen
-        if (!ignoreScreens && cfg_MultipleScreensFilterOccupiedDesktops) {
-            auto windowRect = windowInfo.geometry();
-            auto intersectionRect = screenRect.intersected(windowRect);
-            if (intersectionRect.width() < windowRect.width() / 2 ||
-                intersectionRect.height() < windowRect.height() / 2) {
-                continue;
+        for (int i = 0; i < index.count(number); i++) {
+            auto& entry = index.at(number, i);
+            if (!isFiltered || entry.isOnScreen(screenIndex)) {
+                builder.setWindows(windowCount, isUrgent, entry.name);
+                break;
             }
         }
-
-        windowInfoList << windowInfo;
     }
 
-    return windowInfoList;
+    return builder.build();
 }
 
-QList<int> VirtualDesktopBar::getEmptyDesktopNumberList(bool noCheating) {
-    QList<int> emptyDesktopNumberList;
+QStringList VirtualDesktopBar::getWindowNameList(int number) {
+    QStringList windowNameList;
 
-    for (int i = 1; i <= KWindowSystem::numberOfDesktops(); i++) {
-        auto windowInfoList = getWindowInfoList(i, true);
+    auto& index = core->getWindowIndex();
+    int screenIndex = core->getScreenIndex(screenName);
 
-        if (noCheating) {
-            if (windowInfoList.empty()) {
-                emptyDesktopNumberList << i;
-            }
-            continue;
-        }
+    for (int i = 0; i < index.count(number); i++) {
+        auto& entry = index.at(number, i);
 
-        bool isConsideredEmpty = true;
-        for (auto& windowInfo : windowInfoList) {
-            if (windowInfo.desktop() == i) {
-                isConsideredEmpty = false;
-                break;
-            }
+        // Skipping windows not present on the applet's screen
+        if (cfg_MultipleScreensFilterOccupiedDesktops && !entry.isOnScreen(screenIndex)) {
+            continue;
         }
 
-        if (isConsideredEmpty) {
-            emptyDesktopNumberList << i;
-        }
+        windowNameList << entry.name;
     }
 
-    return emptyDesktopNumberList;
+    return windowNameList;
 }
 
 void VirtualDesktopBar::sendDesktopInfoList() {
-    QVariantList desktopInfoList;
-    for (auto& desktopInfo : getDesktopInfoList(true)) {
-        desktopInfoList << desktopInfo.toQVariantMap();
-    }
-    emit desktopInfoListSent(desktopInfoList);
-}
-
-void VirtualDesktopBar::tryAddEmptyDesktop() {
-    if (cfg_DynamicDesktopsEnable) {
-        auto emptyDesktopNumberList = getEmptyDesktopNumberList(false);
-        if (emptyDesktopNumberList.empty()) {
-            addDesktop();
-        }
-    }
-}
-
-void VirtualDesktopBar::tryRemoveEmptyDesktops() {
-    if (cfg_DynamicDesktopsEnable) {
-        auto emptyDesktopNumberList = getEmptyDesktopNumberList(false);
-        for (int i = 1; i < emptyDesktopNumberList.length(); i++) {
-            int desktopNumber = emptyDesktopNumberList[i];
-            removeDesktop(desktopNumber);
-        }
-    }
-}
-
-void VirtualDesktopBar::tryRenameEmptyDesktops() {
-    if (!cfg_EmptyDesktopsRenameAs.isEmpty()) {
-        auto emptyDesktopNumberList = getEmptyDesktopNumberList();
-        for (int desktopNumber : emptyDesktopNumberList) {
-            renameDesktop(desktopNumber, cfg_EmptyDesktopsRenameAs);
-        }
-    }
-}
+    auto desktopSnapshot = buildDesktopSnapshot();
 
-void VirtualDesktopBar::updateLocalDesktopNumbers() {
-    int n = KWindowSystem::currentDesktop();
-    if (currentDesktopNumber != n) {
-        mostRecentDesktopNumber = currentDesktopNumber;
+    {
+        RefreshStats::Timer timer(core->getStats(), RefreshStats::ModelUpdateStage);
+        desktopListModel->update(std::move(desktopSnapshot));
     }
-    currentDesktopNumber = n;
+    core->getStats()->markStartupPhase(RefreshStats::FirstSnapshotPhase);
 }
@@ -1,18 +1,17 @@
 #pragma once
 
-#include <QAction>
-#include <QDBusInterface>
 #include <QList>
 #include <QObject>
+#include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QVariantList>
 
-#include <netwm.h>
-
-#include <KActionCollection>
-#include <KWindowSystem>
-
-#include "DesktopInfo.hpp"
+#include "DesktopBarCore.hpp"
+#include "DesktopListModel.hpp"
+#include "DesktopSnapshot.hpp"
+#include "RefreshScheduler.hpp"
+#include "RefreshStats.hpp"
 
 class VirtualDesktopBar : public QObject {
     Q_OBJECT
@@ -20,84 +19,118 @@ class VirtualDesktopBar : public QObject {
 public:
     VirtualDesktopBar(QObject* parent = nullptr);
 
+    // A view on the given core instead of the process-wide one
+    VirtualDesktopBar(QSharedPointer<DesktopBarCore> core, QObject* parent = nullptr);
+    ~VirtualDesktopBar() override;
+
     Q_INVOKABLE void requestDesktopInfoList();
 
+    // Names of the windows on the given desktop, topmost first,
+    // computed only when asked for, e.g. when a tooltip is shown
+    Q_INVOKABLE QStringList getWindowNameList(int number);
+
+    DesktopListModel* getDesktopListModel() const;
+    RefreshStats* getStats() const;
+
     Q_INVOKABLE void showDesktop(int number);
     Q_INVOKABLE void addDesktop(unsigned position = 0);
     Q_INVOKABLE void removeDesktop(int number);
+    Q_INVOKABLE void removeDesktops(QList<int> numbers);
     Q_INVOKABLE void renameDesktop(int number, QString name);
     Q_INVOKABLE void replaceDesktops(int number1, int number2);
+    Q_INVOKABLE void moveDesktop(int from, int to);
+    Q_INVOKABLE void applyPermutation(QList<int> permutation);
+
+    Q_PROPERTY(DesktopListModel* desktopListModel
+               READ getDesktopListModel
+               CONSTANT);
+
+    Q_PROPERTY(RefreshStats* stats
+               READ getStats
+               CONSTANT);
+
+    Q_PROPERTY(QString screenName
+               MEMBER screenName
+               NOTIFY screenNameChanged);
+
+    // Whether the labels display window names, title changes
+    // are not worth a refresh if none of the applets does
+    Q_PROPERTY(bool windowNamesShown
+               MEMBER windowNamesShown
+               NOTIFY windowNamesShownChanged);
 
     Q_PROPERTY(QString cfg_EmptyDesktopsRenameAs
                MEMBER cfg_EmptyDesktopsRenameAs
                NOTIFY cfg_EmptyDesktopsRenameAsChanged);
 
     Q_PROPERTY(QString cfg_AddingDesktopsExecuteCommand
-               MEMBER cfg_AddingDesktopsExecuteCommand);
+               MEMBER cfg_AddingDesktopsExecuteCommand
+               NOTIFY cfg_AddingDesktopsExecuteCommandChanged);
+
+    Q_PROPERTY(QString cfg_DesktopLabelsWindowNameRules
+               MEMBER cfg_DesktopLabelsWindowNameRules
+               NOTIFY cfg_DesktopLabelsWindowNameRulesChanged);
 
     Q_PROPERTY(bool cfg_DynamicDesktopsEnable
                MEMBER cfg_DynamicDesktopsEnable
                NOTIFY cfg_DynamicDesktopsEnableChanged);
 
+    Q_PROPERTY(int cfg_DynamicDesktopsRemovalDelay
+               MEMBER cfg_DynamicDesktopsRemovalDelay
+               NOTIFY cfg_DynamicDesktopsRemovalDelayChanged);
+
+    Q_PROPERTY(int cfg_DynamicDesktopsMinimumInterval
+               MEMBER cfg_DynamicDesktopsMinimumInterval
+               NOTIFY cfg_DynamicDesktopsMinimumIntervalChanged);
+
     Q_PROPERTY(bool cfg_MultipleScreensFilterOccupiedDesktops
                MEMBER cfg_MultipleScreensFilterOccupiedDesktops
                NOTIFY cfg_MultipleScreensFilterOccupiedDesktopsChanged);
 
+    Q_PROPERTY(int cfg_PerformanceCoalescingInterval
+               MEMBER cfg_PerformanceCoalescingInterval
+               NOTIFY cfg_PerformanceCoalescingIntervalChanged);
+
+    Q_PROPERTY(bool cfg_AnimationsEnable
+               MEMBER cfg_AnimationsEnable
+               NOTIFY cfg_AnimationsEnableChanged);
+
 signals:
-    void desktopInfoListSent(QVariantList desktopInfoList);
     void requestRenameCurrentDesktop();
+    void screenNameChanged();
+    void windowNamesShownChanged();
 
     void cfg_EmptyDesktopsRenameAsChanged();
     void cfg_AddingDesktopsExecuteCommandChanged();
+    void cfg_DesktopLabelsWindowNameRulesChanged();
     void cfg_DynamicDesktopsEnableChanged();
+    void cfg_DynamicDesktopsRemovalDelayChanged();
+    void cfg_DynamicDesktopsMinimumIntervalChanged();
     void cfg_MultipleScreensFilterOccupiedDesktopsChanged();
+    void cfg_PerformanceCoalescingIntervalChanged();
+    void cfg_AnimationsEnableChanged();
 
 private:
-    NETRootInfo netRootInfo;
-    QDBusInterface dbusInterface;
-    QString dbusInterfaceName;
+    QSharedPointer<DesktopBarCore> core;
 
     void setUpSignals();
-    void setUpKWinSignals();
-    void setUpInternalSignals();
-    void setUpGlobalKeyboardShortcuts();
+    void updateSettings();
 
-    DesktopInfo getDesktopInfo(int number);
-    DesktopInfo getDesktopInfo(QString id);
-    QList<DesktopInfo> getDesktopInfoList(bool extraInfo = false);
-    QList<KWindowInfo> getWindowInfoList(int desktopNumber, bool ignoreScreens = false);
-    QList<int> getEmptyDesktopNumberList(bool noCheating = true);
+    DesktopSnapshot buildDesktopSnapshot();
+
+    QString screenName;
+    bool windowNamesShown;
 
     QString cfg_EmptyDesktopsRenameAs;
     QString cfg_AddingDesktopsExecuteCommand;
+    QString cfg_DesktopLabelsWindowNameRules;
     bool cfg_DynamicDesktopsEnable;
+    int cfg_DynamicDesktopsRemovalDelay;
+    int cfg_DynamicDesktopsMinimumInterval;
     bool cfg_MultipleScreensFilterOccupiedDesktops;
-    bool cfg_MultipleScreensEnableSeparateDesktops;
+    int cfg_PerformanceCoalescingInterval;
+    bool cfg_AnimationsEnable;
 
     void sendDesktopInfoList();
-    bool sendDesktopInfoListLock;
-
-    void tryAddEmptyDesktop();
-    bool tryAddEmptyDesktopLock;
-
-    void tryRemoveEmptyDesktops();
-    bool tryRemoveEmptyDesktopsLock;
-
-    void tryRenameEmptyDesktops();
-    bool tryRenameEmptyDesktopsLock;
-
-    void processChanges(std::function<void()> callback, bool& lock);
-
-    int currentDesktopNumber;
-    int mostRecentDesktopNumber;
-    void updateLocalDesktopNumbers();
-
-    KActionCollection* actionCollection;
-    QAction* actionSwitchToRecentDesktop;
-    QAction* actionAddDesktop;
-    QAction* actionRemoveLastDesktop;
-    QAction* actionRemoveCurrentDesktop;
-    QAction* actionRenameCurrentDesktop;
-    QAction* actionMoveCurrentDesktopToLeft;
-    QAction* actionMoveCurrentDesktopToRight;
+    DesktopListModel* desktopListModel;
 };
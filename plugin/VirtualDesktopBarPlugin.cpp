@@ -2,8 +2,14 @@
 
 #include <QQmlEngine>
 
+#include "DesktopListModel.hpp"
+#include "RefreshStats.hpp"
 #include "VirtualDesktopBar.hpp"
 
 void VirtualDesktopBarPlugin::registerTypes(const char* uri) {
     qmlRegisterType<VirtualDesktopBar>(uri, 1, 2, "VirtualDesktopBar");
+    qmlRegisterUncreatableType<DesktopListModel>(uri, 1, 2, "DesktopListModel",
+                                                 "DesktopListModel is provided by VirtualDesktopBar");
+    qmlRegisterUncreatableType<RefreshStats>(uri, 1, 2, "RefreshStats",
+                                             "RefreshStats is provided by VirtualDesktopBar");
 }
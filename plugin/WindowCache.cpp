@@ -0,0 +1,208 @@
+#include "WindowCache.hpp"
+
+const NET::Properties WindowCache::cachedProperties = NET::WMState |
+                                                      NET::WMDesktop |
+                                                      NET::WMGeometry |
+                                                      NET::WMWindowType |
+                                                      NET::WMName;
+
+bool WindowCache::Record::isSkipped() const {
+    if (state & (NET::SkipPager | NET::SkipTaskbar)) {
+        return true;
+    }
+    return windowType == NET::Dock || windowType == NET::Desktop;
+}
+
+WindowCache::WindowCache(WindowSystemBackend* backend) :
+        backend(backend),
+        stats(nullptr) {}
+
+void WindowCache::populate() {
+    recordHash.clear();
+    nameUseCountHash.clear();
+
+    auto windowPropertiesHash = fetchProperties(backend->windows(), cachedProperties);
+    for (auto it = windowPropertiesHash.constBegin(); it != windowPropertiesHash.constEnd(); it++) {
+        Record record;
+        static_cast<WindowProperties&>(record) = it.value();
+        record.id = it.key();
+        record.name = internName(record.name);
+        recordHash.insert(record.id, record);
+    }
+}
+
+void WindowCache::addWindow(WId id) {
+    Record record;
+    record.id = id;
+    if (fetchRecord(record, cachedProperties)) {
+        record.name = internName(record.name);
+        recordHash.insert(id, record);
+    }
+}
+
+void WindowCache::removeWindow(WId id) {
+    auto it = recordHash.find(id);
+    if (it != recordHash.end()) {
+        releaseName(it->name);
+        recordHash.erase(it);
+    }
+}
+
+WindowCache::Changes WindowCache::updateWindow(WId id, NET::Properties properties, NET::Properties2 /*properties2*/) {
+    auto it = recordHash.find(id);
+    if (it == recordHash.end()) {
+        addWindow(id);
+        return recordHash.contains(id) ? VisibilityChange : NoChange;
+    }
+
+    NET::Properties fetchedProperties = getFetchedProperties(properties);
+    if (!fetchedProperties) {
+        return NoChange;
+    }
+
+    Record record = *it;
+    if (!fetchRecord(record, fetchedProperties)) {
+        bool wasSkipped = it->isSkipped();
+        removeWindow(id);
+        return wasSkipped ? NoChange : VisibilityChange;
+    }
+
+    return replaceRecord(it, record);
+}
+
+void WindowCache::insertWindow(WId id, const WindowProperties& windowProperties) {
+    removeWindow(id);
+
+    Record record;
+    static_cast<WindowProperties&>(record) = windowProperties;
+    record.id = id;
+    record.name = internName(record.name);
+    recordHash.insert(id, record);
+}
+
+WindowCache::Changes WindowCache::applyWindow(WId id, NET::Properties properties, const WindowProperties& windowProperties) {
+    auto it = recordHash.find(id);
+    if (it == recordHash.end()) {
+        return NoChange;
+    }
+
+    Record record = *it;
+    record.copy(windowProperties, properties & cachedProperties);
+    return replaceRecord(it, record);
+}
+
+NET::Properties WindowCache::getFetchedProperties(NET::Properties properties) {
+    NET::Properties fetchedProperties = properties & cachedProperties;
+    if (properties & NET::WMVisibleName) {
+        fetchedProperties |= NET::WMName;
+    }
+    return fetchedProperties;
+}
+
+WindowCache::Changes WindowCache::replaceRecord(QHash<WId, Record>::iterator it, Record& record) {
+    Changes changes = NoChange;
+    if (record.desktopNumber != it->desktopNumber) {
+        changes |= DesktopChange;
+    }
+    if (record.isSkipped() != it->isSkipped()) {
+        changes |= VisibilityChange;
+    }
+    if ((record.state ^ it->state) & NET::DemandsAttention) {
+        changes |= UrgencyChange;
+    }
+    if (record.name != it->name) {
+        releaseName(it->name);
+        record.name = internName(record.name);
+        changes |= NameChange;
+    }
+    if (record.geometry != it->geometry) {
+        changes |= GeometryChange;
+    }
+
+    bool isSkipped = record.isSkipped() && it->isSkipped();
+    *it = record;
+    return isSkipped ? NoChange : changes;
+}
+
+bool WindowCache::setNameRules(const QString& rules) {
+    if (!nameParser.setRules(rules)) {
+        return false;
+    }
+
+    // Full names are not kept, so they have to be fetched again
+    bool changed = false;
+    auto windowPropertiesHash = fetchProperties(recordHash.keys(), NET::WMName);
+    for (auto it = recordHash.begin(); it != recordHash.end(); it++) {
+        auto windowPropertiesIt = windowPropertiesHash.constFind(it.key());
+        if (windowPropertiesIt == windowPropertiesHash.constEnd()) {
+            continue;
+        }
+        if (windowPropertiesIt->name != it->name) {
+            releaseName(it->name);
+            it->name = internName(windowPropertiesIt->name);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+const WindowCache::Record* WindowCache::find(WId id) const {
+    auto it = recordHash.constFind(id);
+    return it != recordHash.constEnd() ? &*it : nullptr;
+}
+
+void WindowCache::setStats(RefreshStats* stats) {
+    this->stats = stats;
+}
+
+bool WindowCache::fetchRecord(Record& record, NET::Properties properties) {
+    RefreshStats::Timer timer(stats, RefreshStats::WindowFetchStage);
+    if (stats) {
+        stats->increment(RefreshStats::XRoundTripCounter);
+    }
+
+    if (!backend->fetchWindow(record.id, properties, record)) {
+        return false;
+    }
+
+    if (properties & NET::WMName) {
+        RefreshStats::Timer timer(stats, RefreshStats::TitleParseStage);
+        record.name = nameParser.parse(record.name);
+    }
+    return true;
+}
+
+QHash<WId, WindowProperties> WindowCache::fetchProperties(const QList<WId>& idList, NET::Properties properties) {
+    QHash<WId, WindowProperties> windowPropertiesHash;
+    {
+        RefreshStats::Timer timer(stats, RefreshStats::WindowFetchStage);
+        if (stats) {
+            stats->increment(RefreshStats::XRoundTripCounter);
+        }
+        windowPropertiesHash = backend->fetchWindows(idList, properties);
+    }
+
+    if (properties & NET::WMName) {
+        RefreshStats::Timer timer(stats, RefreshStats::TitleParseStage);
+        for (auto& windowProperties : windowPropertiesHash) {
+            windowProperties.name = nameParser.parse(windowProperties.name);
+        }
+    }
+    return windowPropertiesHash;
+}
+
+QString WindowCache::internName(const QString& name) {
+    auto it = nameUseCountHash.find(name);
+    if (it == nameUseCountHash.end()) {
+        it = nameUseCountHash.insert(name, 0);
+    }
+    it.value()++;
+    return it.key();
+}
+
+void WindowCache::releaseName(const QString& name) {
+    auto it = nameUseCountHash.find(name);
+    if (it != nameUseCountHash.end() && --it.value() <= 0) {
+        nameUseCountHash.erase(it);
+    }
+}
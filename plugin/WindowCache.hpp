@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <KWindowSystem>
+
+#include "RefreshStats.hpp"
+#include "WindowNameParser.hpp"
+#include "WindowSystemBackend.hpp"
+
+class WindowCache {
+public:
+    // Cached properties, with the name already parsed
+    class Record : public WindowProperties {
+    public:
+        WId id = 0;
+
+        // Whether the window should never be shown by the applet
+        bool isSkipped() const;
+    };
+
+    // Parts of a window's record the applet can show
+    enum Change {
+        NoChange = 0,
+        DesktopChange = 1 << 0,
+        VisibilityChange = 1 << 1,
+        UrgencyChange = 1 << 2,
+        NameChange = 1 << 3,
+        GeometryChange = 1 << 4
+    };
+    Q_DECLARE_FLAGS(Changes, Change)
+
+    WindowCache(WindowSystemBackend* backend);
+
+    // Fetches properties of all the currently managed windows
+    void populate();
+
+    void addWindow(WId id);
+    void removeWindow(WId id);
+
+    // Re-fetches only the cached properties present in the masks and
+    // returns which of the shown parts changed compared to the previous
+    // record, changes of windows skipped before and after are ignored
+    Changes updateWindow(WId id, NET::Properties properties, NET::Properties2 properties2);
+
+    // The same for properties fetched elsewhere, with names already parsed
+    void insertWindow(WId id, const WindowProperties& windowProperties);
+    Changes applyWindow(WId id, NET::Properties properties, const WindowProperties& windowProperties);
+
+    // Properties to re-fetch for the ones in a change notification
+    static NET::Properties getFetchedProperties(NET::Properties properties);
+    static const NET::Properties cachedProperties;
+
+    const Record* find(WId id) const;
+
+    // Parses the names of all windows again if the rules changed,
+    // returns whether any of the names actually changed
+    bool setNameRules(const QString& rules);
+
+    void setStats(RefreshStats* stats);
+
+private:
+    WindowSystemBackend* backend;
+    QHash<WId, Record> recordHash;
+    RefreshStats* stats;
+
+    Changes replaceRecord(QHash<WId, Record>::iterator it, Record& record);
+
+    bool fetchRecord(Record& record, NET::Properties properties);
+
+    // Fetches many windows in a single batch, windows that are gone are left out
+    QHash<WId, WindowProperties> fetchProperties(const QList<WId>& idList, NET::Properties properties);
+
+    // Parsed names are shared by all the windows having them,
+    // so every distinct name is stored only once
+    WindowNameParser nameParser;
+    QHash<QString, int> nameUseCountHash;
+    QString internName(const QString& name);
+    void releaseName(const QString& name);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(WindowCache::Changes)
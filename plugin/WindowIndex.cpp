@@ -0,0 +1,151 @@
+#include "WindowIndex.hpp"
+
+void WindowIndex::rebuild(const WindowCache& windowCache, const QList<WId>& stackingOrder,
+                          int numberOfDesktops, const QList<QRect>& screenRectList) {
+    RefreshStats::Timer timer(stats, RefreshStats::WindowIndexStage);
+
+    entryList.clear();
+    bucketList.clear();
+    bucketOffsetList.fill(0, numberOfDesktops + 1);
+    ownWindowCountList.fill(0, numberOfDesktops + 1);
+
+    screenCount = qBound(1, screenRectList.length(), maxScreenCount);
+    occupancyList.fill(0, (numberOfDesktops + 1) * screenCount);
+    urgencyList.fill(0, (numberOfDesktops + 1) * screenCount);
+    urgentWindowCountList.fill(0, numberOfDesktops + 1);
+
+    int stickyWindowCount = 0;
+
+    entryList.reserve(stackingOrder.length());
+
+    if (stats) {
+        stats->increment(RefreshStats::WindowScanCounter, stackingOrder.length());
+    }
+
+    for (int i = stackingOrder.length() - 1; i >= 0; i--) {
+        auto* record = windowCache.find(stackingOrder[i]);
+        if (!record || record->isSkipped()) {
+            continue;
+        }
+
+        int desktopNumber = record->desktopNumber;
+        if (desktopNumber == NET::OnAllDesktops) {
+            stickyWindowCount++;
+        } else if (desktopNumber >= 1 && desktopNumber <= numberOfDesktops) {
+            ownWindowCountList[desktopNumber]++;
+        } else {
+            continue;
+        }
+
+        Entry entry;
+        entry.id = record->id;
+        entry.desktopNumber = desktopNumber;
+        entry.isUrgent = record->state & NET::DemandsAttention;
+        entry.name = record->name;
+
+        // A window is on a screen if at least a half of it is there
+        auto& windowRect = record->geometry;
+        for (int s = 0; s < screenRectList.length(); s++) {
+            auto intersectionRect = screenRectList[s].intersected(windowRect);
+            if (intersectionRect.width() >= windowRect.width() / 2 &&
+                intersectionRect.height() >= windowRect.height() / 2) {
+                entry.screenMask |= 1u << qMin(s, screenCount - 1);
+            }
+        }
+        if (screenRectList.isEmpty()) {
+            entry.screenMask = 1;
+        }
+
+        // Sticky windows are counted in the row of desktop 0,
+        // which is added to every desktop's row below
+        int row = desktopNumber == NET::OnAllDesktops ? 0 : desktopNumber;
+        for (int s = 0; s < screenCount; s++) {
+            if (entry.screenMask & (1u << s)) {
+                occupancyList[row * screenCount + s]++;
+                urgencyList[row * screenCount + s] += entry.isUrgent;
+            }
+        }
+        urgentWindowCountList[row] += entry.isUrgent;
+
+        entryList << entry;
+    }
+
+    for (int n = 1; n <= numberOfDesktops; n++) {
+        for (int s = 0; s < screenCount; s++) {
+            occupancyList[n * screenCount + s] += occupancyList[s];
+            urgencyList[n * screenCount + s] += urgencyList[s];
+        }
+        urgentWindowCountList[n] += urgentWindowCountList[0];
+    }
+
+    // Counting sort into per-desktop buckets, which keeps the stacking order
+    for (int n = 1; n <= numberOfDesktops; n++) {
+        bucketOffsetList[n] = bucketOffsetList[n - 1] + ownWindowCountList[n] + stickyWindowCount;
+    }
+    bucketList.resize(bucketOffsetList[numberOfDesktops]);
+
+    QVector<int> cursorList = bucketOffsetList;
+    for (int i = 0; i < entryList.length(); i++) {
+        int desktopNumber = entryList[i].desktopNumber;
+        if (desktopNumber == NET::OnAllDesktops) {
+            for (int n = 1; n <= numberOfDesktops; n++) {
+                bucketList[cursorList[n - 1]++] = i;
+            }
+        } else {
+            bucketList[cursorList[desktopNumber - 1]++] = i;
+        }
+    }
+}
+
+int WindowIndex::count(int desktopNumber) const {
+    if (desktopNumber < 1 || desktopNumber >= bucketOffsetList.length()) {
+        return 0;
+    }
+    return bucketOffsetList[desktopNumber] - bucketOffsetList[desktopNumber - 1];
+}
+
+const WindowIndex::Entry& WindowIndex::at(int desktopNumber, int i) const {
+    return entryList[bucketList[bucketOffsetList[desktopNumber - 1] + i]];
+}
+
+bool WindowIndex::Entry::isOnScreen(int screenIndex) const {
+    return screenMask & (1u << qBound(0, screenIndex, maxScreenCount - 1));
+}
+
+bool WindowIndex::hasOwnWindows(int desktopNumber) const {
+    if (desktopNumber < 1 || desktopNumber >= ownWindowCountList.length()) {
+        return false;
+    }
+    return ownWindowCountList[desktopNumber] > 0;
+}
+
+int WindowIndex::count(int desktopNumber, int screenIndex) const {
+    if (desktopNumber < 1 || desktopNumber >= ownWindowCountList.length()) {
+        return 0;
+    }
+    screenIndex = qBound(0, screenIndex, screenCount - 1);
+    return occupancyList[desktopNumber * screenCount + screenIndex];
+}
+
+bool WindowIndex::isOccupied(int desktopNumber, int screenIndex) const {
+    return count(desktopNumber, screenIndex) > 0;
+}
+
+bool WindowIndex::isUrgent(int desktopNumber) const {
+    if (desktopNumber < 1 || desktopNumber >= urgentWindowCountList.length()) {
+        return false;
+    }
+    return urgentWindowCountList[desktopNumber] > 0;
+}
+
+bool WindowIndex::isUrgent(int desktopNumber, int screenIndex) const {
+    if (desktopNumber < 1 || desktopNumber >= urgentWindowCountList.length()) {
+        return false;
+    }
+    screenIndex = qBound(0, screenIndex, screenCount - 1);
+    return urgencyList[desktopNumber * screenCount + screenIndex] > 0;
+}
+
+void WindowIndex::setStats(RefreshStats* stats) {
+    this->stats = stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QList>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+#include <KWindowSystem>
+
+#include "RefreshStats.hpp"
+#include "WindowCache.hpp"
+
+class WindowIndex {
+public:
+    class Entry {
+    public:
+        WId id = 0;
+        int desktopNumber = 0;
+        bool isUrgent = false;
+        quint32 screenMask = 0;
+        QString name;
+
+        bool isOnScreen(int screenIndex) const;
+    };
+
+    // At most this many screens are told apart,
+    // the ones past it share the last screen's bit
+    static const int maxScreenCount = 32;
+
+    // Walks the stacking order once and buckets cached windows by desktop,
+    // counting the windows and the urgent ones on every desktop and screen pair as well
+    void rebuild(const WindowCache& windowCache, const QList<WId>& stackingOrder,
+                 int numberOfDesktops, const QList<QRect>& screenRectList);
+
+    // Windows visible on the given desktop, topmost first,
+    // including the ones present on all desktops
+    int count(int desktopNumber) const;
+    const Entry& at(int desktopNumber, int i) const;
+
+    // Whether there are windows placed exactly on the given desktop
+    bool hasOwnWindows(int desktopNumber) const;
+
+    // Windows visible on the given desktop that are on the given screen
+    int count(int desktopNumber, int screenIndex) const;
+    bool isOccupied(int desktopNumber, int screenIndex) const;
+
+    // Whether any window visible on the given desktop demands attention,
+    // optionally only among the ones on the given screen
+    bool isUrgent(int desktopNumber) const;
+    bool isUrgent(int desktopNumber, int screenIndex) const;
+
+    void setStats(RefreshStats* stats);
+
+private:
+    RefreshStats* stats = nullptr;
+
+    QVector<Entry> entryList;
+    QVector<int> bucketList;
+    QVector<int> bucketOffsetList;
+    QVector<int> ownWindowCountList;
+
+    int screenCount = 0;
+    QVector<int> occupancyList;
+    QVector<int> urgencyList;
+    QVector<int> urgentWindowCountList;
+};
@@ -0,0 +1,55 @@
+#include "WindowNameParser.hpp"
+
+#include <QStringList>
+#include <QtGlobal>
+
+const QString WindowNameParser::defaultRules = QString::fromUtf8("^.* [-–—] (.*)$");
+
+WindowNameParser::WindowNameParser() {
+    setRules(QString());
+}
+
+bool WindowNameParser::setRules(const QString& rules) {
+    QString newRules = rules.trimmed().isEmpty() ? defaultRules : rules;
+    if (newRules == this->rules) {
+        return false;
+    }
+
+    this->rules = newRules;
+    ruleList = compile(newRules);
+
+    // Rules none of which can be used would show full names, unlike no rules
+    if (ruleList.isEmpty()) {
+        qWarning("None of the window name rules is a valid regular expression with a capturing group, "
+                 "using the default ones");
+        ruleList = compile(defaultRules);
+    }
+
+    return true;
+}
+
+QList<QRegularExpression> WindowNameParser::compile(const QString& rules) {
+    QList<QRegularExpression> ruleList;
+
+    for (auto& pattern : rules.split('\n', QString::SkipEmptyParts)) {
+        QRegularExpression rule(pattern);
+        if (!rule.isValid() || rule.captureCount() < 1) {
+            continue;
+        }
+
+        rule.optimize();
+        ruleList << rule;
+    }
+
+    return ruleList;
+}
+
+QString WindowNameParser::parse(const QString& windowName) const {
+    for (auto& rule : ruleList) {
+        auto match = rule.match(windowName);
+        if (match.hasMatch()) {
+            return match.captured(1).trimmed();
+        }
+    }
+    return windowName;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+
+class WindowNameParser {
+public:
+    WindowNameParser();
+
+    // One regular expression per line, compiled once. The first one matching
+    // a window's full name decides, its first capturing group is the name
+    // shown by the applet. Empty rules stand for the default ones, which
+    // take the part after the last " - ", " – " or " — " separator, so do
+    // rules none of which is valid and has a capturing group.
+    // Returns whether the rules actually changed
+    bool setRules(const QString& rules);
+
+    QString parse(const QString& windowName) const;
+
+private:
+    QString rules;
+    QList<QRegularExpression> ruleList;
+
+    static const QString defaultRules;
+    static QList<QRegularExpression> compile(const QString& rules);
+};
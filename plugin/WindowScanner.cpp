@@ -0,0 +1,144 @@
+#include "WindowScanner.hpp"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+WindowScanner::WindowScanner(WindowSystemBackend::WindowFetchFunction fetchFunction, QObject* parent) : QObject(parent),
+        worker(new QObject),
+        fetchFunction(fetchFunction),
+        isScanScheduled(false),
+        isScanning(false),
+        publishedSnapshot(nullptr) {
+
+    worker->moveToThread(&thread);
+
+    // Queued, as the worker lives in the other thread
+    QObject::connect(this, &WindowScanner::scanRequested, worker, [&] {
+        scan();
+    });
+
+    thread.start();
+}
+
+WindowScanner::~WindowScanner() {
+    thread.quit();
+    thread.wait();
+    delete worker;
+    delete publishedSnapshot.fetchAndStoreOrdered(nullptr);
+}
+
+void WindowScanner::request(WId id, NET::Properties properties) {
+    QMutexLocker locker(&mutex);
+    pendingRequestHash[id] |= properties;
+    if (!isScanScheduled) {
+        isScanScheduled = true;
+        emit scanRequested();
+    }
+}
+
+void WindowScanner::cancel(WId id) {
+    QMutexLocker locker(&mutex);
+    pendingRequestHash.remove(id);
+}
+
+void WindowScanner::setNameRules(const QString& rules) {
+    QMutexLocker locker(&mutex);
+    nameRules = rules;
+}
+
+const WindowScanner::Snapshot* WindowScanner::takeSnapshot() {
+    return publishedSnapshot.fetchAndStoreOrdered(nullptr);
+}
+
+bool WindowScanner::isIdle() {
+    QMutexLocker locker(&mutex);
+    return pendingRequestHash.isEmpty() && !isScanScheduled && !isScanning &&
+           !publishedSnapshot.loadAcquire();
+}
+
+void WindowScanner::scan() {
+    QHash<WId, NET::Properties> requestHash;
+    QString rules;
+    {
+        QMutexLocker locker(&mutex);
+        requestHash.swap(pendingRequestHash);
+        rules = nameRules;
+        isScanScheduled = false;
+        isScanning = !requestHash.isEmpty();
+    }
+
+    if (requestHash.isEmpty()) {
+        return;
+    }
+    nameParser.setRules(rules);
+
+    // Windows asked for the same properties are fetched in a single batch
+    QHash<int, QList<WId>> idListHash;
+    for (auto it = requestHash.constBegin(); it != requestHash.constEnd(); it++) {
+        idListHash[int(it.value())] << it.key();
+    }
+
+    auto* snapshot = new Snapshot;
+    snapshot->resultHash.reserve(requestHash.size());
+
+    for (auto it = idListHash.constBegin(); it != idListHash.constEnd(); it++) {
+        NET::Properties properties(QFlag(it.key()));
+
+        QElapsedTimer elapsedTimer;
+        elapsedTimer.start();
+        auto windowPropertiesHash = fetchFunction(it.value(), properties);
+        snapshot->fetchNsecsList << elapsedTimer.nsecsElapsed();
+
+        if (properties & NET::WMName) {
+            elapsedTimer.start();
+            for (auto& windowProperties : windowPropertiesHash) {
+                windowProperties.name = nameParser.parse(windowProperties.name);
+            }
+            snapshot->parseNsecsList << elapsedTimer.nsecsElapsed();
+        }
+
+        for (WId id : it.value()) {
+            Result result;
+            result.properties = properties;
+
+            auto windowPropertiesIt = windowPropertiesHash.constFind(id);
+            if (windowPropertiesIt != windowPropertiesHash.constEnd()) {
+                result.isValid = true;
+                result.windowProperties = *windowPropertiesIt;
+            }
+
+            snapshot->resultHash.insert(id, result);
+        }
+    }
+
+    publish(snapshot);
+
+    QMutexLocker locker(&mutex);
+    isScanning = false;
+}
+
+void WindowScanner::publish(Snapshot* snapshot) {
+    // A snapshot not taken yet is merged into the new one, so no result
+    // is lost; it is never modified, only replaced and then deleted
+    auto* previousSnapshot = publishedSnapshot.fetchAndStoreOrdered(nullptr);
+    if (previousSnapshot) {
+        auto& previousResultHash = previousSnapshot->resultHash;
+        for (auto it = previousResultHash.constBegin(); it != previousResultHash.constEnd(); it++) {
+            auto newIt = snapshot->resultHash.find(it.key());
+            if (newIt == snapshot->resultHash.end()) {
+                snapshot->resultHash.insert(it.key(), it.value());
+            } else if (newIt->isValid && it->isValid) {
+                Result result = it.value();
+                result.windowProperties.copy(newIt->windowProperties, newIt->properties);
+                result.properties |= newIt->properties;
+                *newIt = result;
+            }
+        }
+        snapshot->fetchNsecsList += previousSnapshot->fetchNsecsList;
+        snapshot->parseNsecsList += previousSnapshot->parseNsecsList;
+        delete previousSnapshot;
+    }
+
+    publishedSnapshot.fetchAndStoreOrdered(snapshot);
+    emit snapshotPublished();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+
+#include <QAtomicPointer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include <KWindowSystem>
+
+#include "WindowNameParser.hpp"
+#include "WindowSystemBackend.hpp"
+
+// Fetches window properties and parses window names on a worker thread,
+// so a burst of window changes, e.g. at session restore, does not block
+// the GUI thread. Finished results are published as immutable snapshots
+// through an atomically swapped pointer, the GUI thread only applies them
+class WindowScanner : public QObject {
+    Q_OBJECT
+
+public:
+    class Result {
+    public:
+        NET::Properties properties;
+        WindowProperties windowProperties;
+        bool isValid = false;
+    };
+
+    class Snapshot {
+    public:
+        // Only the requested properties are set, names are already parsed
+        QHash<WId, Result> resultHash;
+
+        // Time taken by every batch fetched and parsed, in nanoseconds,
+        // to be recorded in the stats on the GUI thread
+        QVector<qint64> fetchNsecsList;
+        QVector<qint64> parseNsecsList;
+    };
+
+    // The fetch function is called on the worker thread only
+    WindowScanner(WindowSystemBackend::WindowFetchFunction fetchFunction, QObject* parent = nullptr);
+    ~WindowScanner() override;
+
+    // Requests to the same window made before it is scanned are merged
+    void request(WId id, NET::Properties properties);
+    void cancel(WId id);
+    void setNameRules(const QString& rules);
+
+    // Takes the results published so far, the caller owns the snapshot
+    const Snapshot* takeSnapshot();
+
+    // Whether nothing is requested, being scanned or published and not taken
+    bool isIdle();
+
+signals:
+    // Emitted on the worker thread, should be connected to in a queued way
+    void snapshotPublished();
+
+    // Used internally to wake the worker up
+    void scanRequested();
+
+private:
+    QThread thread;
+    QObject* worker;
+
+    WindowSystemBackend::WindowFetchFunction fetchFunction;
+    WindowNameParser nameParser;
+
+    // Guarded by the mutex, touched by both threads
+    QMutex mutex;
+    QHash<WId, NET::Properties> pendingRequestHash;
+    QString nameRules;
+    bool isScanScheduled;
+    bool isScanning;
+
+    QAtomicPointer<const Snapshot> publishedSnapshot;
+
+    void scan();
+    void publish(Snapshot* snapshot);
+};
@@ -0,0 +1,38 @@
+#include "WindowSystemBackend.hpp"
+
+void WindowProperties::copy(const WindowProperties& other, NET::Properties properties) {
+    if (properties & NET::WMState) {
+        state = other.state;
+    }
+    if (properties & NET::WMDesktop) {
+        desktopNumber = other.desktopNumber;
+    }
+    if (properties & NET::WMGeometry) {
+        geometry = other.geometry;
+    }
+    if (properties & NET::WMWindowType) {
+        windowType = other.windowType;
+    }
+    if (properties & NET::WMName) {
+        name = other.name;
+    }
+}
+
+WindowSystemBackend::WindowSystemBackend(QObject* parent) : QObject(parent) {}
+
+QHash<WId, WindowProperties> WindowSystemBackend::fetchWindows(const QList<WId>& idList, NET::Properties properties) {
+    QHash<WId, WindowProperties> windowPropertiesHash;
+    for (WId id : idList) {
+        WindowProperties windowProperties;
+        if (fetchWindow(id, properties, windowProperties)) {
+            windowPropertiesHash.insert(id, windowProperties);
+        }
+    }
+    return windowPropertiesHash;
+}
+
+WindowSystemBackend::WindowFetchFunction WindowSystemBackend::createWindowFetchFunction() {
+    return nullptr;
+}
+
+void WindowSystemBackend::setStats(RefreshStats* /*stats*/) {}
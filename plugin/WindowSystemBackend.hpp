@@ -0,0 +1,100 @@
+#pragma once
+
+#include <functional>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QRect>
+#include <QString>
+
+#include <KWindowSystem>
+
+#include "DesktopInfo.hpp"
+#include "RefreshStats.hpp"
+#include "X11Batch.hpp"
+
+class WindowProperties {
+public:
+    NET::States state;
+    int desktopNumber = 0;
+    QRect geometry;
+    NET::WindowType windowType = NET::Unknown;
+    QString name;
+
+    // Copies only the given properties from the other window
+    void copy(const WindowProperties& other, NET::Properties properties);
+};
+
+class ScreenInfo {
+public:
+    QString name;
+    QRect geometry;
+};
+
+// Everything the applet needs from the window system and from KWin's
+// virtual desktop manager, so the logic can run against a fake as well
+class WindowSystemBackend : public QObject {
+    Q_OBJECT
+
+public:
+    using DesktopListCallback = std::function<void(bool isValid, const QList<DesktopInfo>& desktopInfoList)>;
+    using ResultCallback = std::function<void(bool isSuccessful)>;
+    using WindowFetchFunction = std::function<QHash<WId, WindowProperties>(const QList<WId>& idList,
+                                                                           NET::Properties properties)>;
+
+    WindowSystemBackend(QObject* parent = nullptr);
+
+    virtual int currentDesktop() const = 0;
+    virtual int numberOfDesktops() const = 0;
+    virtual QString desktopName(int number) const = 0;
+    virtual QList<WId> windows() const = 0;
+    virtual QList<WId> stackingOrder() const = 0;
+    virtual QList<ScreenInfo> screens() const = 0;
+
+    // Fetches only the requested properties,
+    // returns false if the window does not exist anymore
+    virtual bool fetchWindow(WId id, NET::Properties properties, WindowProperties& windowProperties) = 0;
+
+    // Fetches the requested properties of many windows at once, leaving out
+    // the ones that do not exist anymore, by default one window after another
+    virtual QHash<WId, WindowProperties> fetchWindows(const QList<WId>& idList, NET::Properties properties);
+
+    // Creates a function doing what fetchWindows does, but safe to call from
+    // another thread, or returns null if the backend cannot provide one
+    virtual WindowFetchFunction createWindowFetchFunction();
+
+    virtual void setCurrentDesktop(int number) = 0;
+    virtual void setNumberOfDesktops(int numberOfDesktops) = 0;
+    virtual void setDesktopName(int number, const QString& name) = 0;
+    virtual void commit(X11Batch& batch) = 0;
+
+    // Desktop manager requests, callbacks are invoked asynchronously
+    // and in the order in which the requests were made
+    virtual void fetchDesktops(DesktopListCallback callback) = 0;
+    virtual void removeDesktop(const QString& id, ResultCallback callback) = 0;
+    virtual void renameDesktop(const QString& id, const QString& name, ResultCallback callback) = 0;
+
+    virtual void setStats(RefreshStats* stats);
+
+signals:
+    void currentDesktopChanged(int number);
+    void numberOfDesktopsChanged(int numberOfDesktops);
+    void desktopNamesChanged();
+    void windowAdded(WId id);
+    void windowRemoved(WId id);
+    void windowChanged(WId id, NET::Properties properties, NET::Properties2 properties2);
+    void stackingOrderChanged();
+    void screensChanged();
+
+    void desktopCreated(const DesktopInfo& desktopInfo);
+    void desktopRemoved(const QString& id);
+    void desktopDataChanged(const DesktopInfo& desktopInfo);
+    void desktopsChanged(const QList<DesktopInfo>& desktopInfoList);
+
+    // Results of the desktop manager requests, emitted right before
+    // their callbacks are invoked, so sessions can be recorded
+    void desktopsFetched(bool isValid, const QList<DesktopInfo>& desktopInfoList);
+    void desktopRemoveFinished(const QString& id, bool isSuccessful);
+    void desktopRenameFinished(const QString& id, const QString& name, bool isSuccessful);
+};
@@ -0,0 +1,51 @@
+#include "X11Batch.hpp"
+
+void X11Batch::moveWindow(WId id, int desktopNumber) {
+    windowMoveList << qMakePair(id, desktopNumber);
+}
+
+void X11Batch::setDesktopNames(const QStringList& desktopNameList) {
+    this->desktopNameList = desktopNameList;
+    desktopNamesSet = true;
+}
+
+void X11Batch::setNumberOfDesktops(int numberOfDesktops) {
+    this->numberOfDesktops = numberOfDesktops;
+}
+
+void X11Batch::setCurrentDesktop(int desktopNumber) {
+    currentDesktopNumber = desktopNumber;
+}
+
+const QList<QPair<WId, int>>& X11Batch::getWindowMoveList() const {
+    return windowMoveList;
+}
+
+const QStringList& X11Batch::getDesktopNameList() const {
+    return desktopNameList;
+}
+
+bool X11Batch::hasDesktopNames() const {
+    return desktopNamesSet;
+}
+
+int X11Batch::getNumberOfDesktops() const {
+    return numberOfDesktops;
+}
+
+int X11Batch::getCurrentDesktopNumber() const {
+    return currentDesktopNumber;
+}
+
+bool X11Batch::isEmpty() const {
+    return windowMoveList.isEmpty() && !desktopNamesSet &&
+           numberOfDesktops <= 0 && currentDesktopNumber <= 0;
+}
+
+void X11Batch::clear() {
+    windowMoveList.clear();
+    desktopNameList.clear();
+    desktopNamesSet = false;
+    numberOfDesktops = 0;
+    currentDesktopNumber = 0;
+}
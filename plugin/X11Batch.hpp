@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QList>
+#include <QPair>
+#include <QStringList>
+
+#include <KWindowSystem>
+
+// Requests to the window manager, collected so the backend
+// can send all of them at once, in order: window moves, desktop names,
+// number of desktops, current desktop
+class X11Batch {
+public:
+    void moveWindow(WId id, int desktopNumber);
+    void setDesktopNames(const QStringList& desktopNameList);
+    void setNumberOfDesktops(int numberOfDesktops);
+    void setCurrentDesktop(int desktopNumber);
+
+    const QList<QPair<WId, int>>& getWindowMoveList() const;
+    const QStringList& getDesktopNameList() const;
+    bool hasDesktopNames() const;
+    int getNumberOfDesktops() const;
+    int getCurrentDesktopNumber() const;
+
+    bool isEmpty() const;
+    void clear();
+
+private:
+    QList<QPair<WId, int>> windowMoveList;
+    QStringList desktopNameList;
+    bool desktopNamesSet = false;
+    int numberOfDesktops = 0;
+    int currentDesktopNumber = 0;
+};
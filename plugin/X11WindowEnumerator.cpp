@@ -0,0 +1,306 @@
+#include "X11WindowEnumerator.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <QVector>
+
+namespace {
+
+class AtomState {
+public:
+    const char* name;
+    NET::State state;
+};
+
+class AtomWindowType {
+public:
+    const char* name;
+    NET::WindowType windowType;
+};
+
+const AtomState atomStateList[] = {
+    { "_NET_WM_STATE_MODAL", NET::Modal },
+    { "_NET_WM_STATE_STICKY", NET::Sticky },
+    { "_NET_WM_STATE_MAXIMIZED_VERT", NET::MaxVert },
+    { "_NET_WM_STATE_MAXIMIZED_HORZ", NET::MaxHoriz },
+    { "_NET_WM_STATE_SHADED", NET::Shaded },
+    { "_NET_WM_STATE_SKIP_TASKBAR", NET::SkipTaskbar },
+    { "_NET_WM_STATE_SKIP_PAGER", NET::SkipPager },
+    { "_NET_WM_STATE_HIDDEN", NET::Hidden },
+    { "_NET_WM_STATE_FULLSCREEN", NET::FullScreen },
+    { "_NET_WM_STATE_ABOVE", NET::KeepAbove },
+    { "_NET_WM_STATE_BELOW", NET::KeepBelow },
+    { "_NET_WM_STATE_DEMANDS_ATTENTION", NET::DemandsAttention }
+};
+
+const AtomWindowType atomWindowTypeList[] = {
+    { "_NET_WM_WINDOW_TYPE_NORMAL", NET::Normal },
+    { "_NET_WM_WINDOW_TYPE_DESKTOP", NET::Desktop },
+    { "_NET_WM_WINDOW_TYPE_DOCK", NET::Dock },
+    { "_NET_WM_WINDOW_TYPE_TOOLBAR", NET::Toolbar },
+    { "_NET_WM_WINDOW_TYPE_MENU", NET::Menu },
+    { "_NET_WM_WINDOW_TYPE_DIALOG", NET::Dialog },
+    { "_NET_WM_WINDOW_TYPE_UTILITY", NET::Utility },
+    { "_NET_WM_WINDOW_TYPE_SPLASH", NET::Splash },
+    { "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU", NET::DropdownMenu },
+    { "_NET_WM_WINDOW_TYPE_POPUP_MENU", NET::PopupMenu },
+    { "_NET_WM_WINDOW_TYPE_TOOLTIP", NET::Tooltip },
+    { "_NET_WM_WINDOW_TYPE_NOTIFICATION", NET::Notification },
+    { "_NET_WM_WINDOW_TYPE_COMBO", NET::ComboBox },
+    { "_NET_WM_WINDOW_TYPE_DND", NET::DNDIcon },
+    { "_KDE_NET_WM_WINDOW_TYPE_OVERRIDE", NET::Override },
+    { "_KDE_NET_WM_WINDOW_TYPE_TOPMENU", NET::TopMenu }
+};
+
+// Names are limited to this many 32-bit units, longer ones are truncated
+const uint32_t maxNameLength = 1024;
+
+class Cookies {
+public:
+    xcb_get_geometry_cookie_t geometry;
+    xcb_translate_coordinates_cookie_t position;
+    xcb_get_property_cookie_t state;
+    xcb_get_property_cookie_t desktop;
+    xcb_get_property_cookie_t windowType;
+    xcb_get_property_cookie_t name;
+};
+
+}
+
+X11WindowEnumerator::X11WindowEnumerator(xcb_connection_t* connection, xcb_window_t rootWindow) :
+        connection(connection),
+        rootWindow(rootWindow),
+        isInterned(false),
+        netWmState(XCB_ATOM_NONE),
+        netWmDesktop(XCB_ATOM_NONE),
+        netWmWindowType(XCB_ATOM_NONE),
+        netWmName(XCB_ATOM_NONE),
+        utf8String(XCB_ATOM_NONE) {}
+
+QHash<WId, WindowProperties> X11WindowEnumerator::fetch(const QList<WId>& idList, NET::Properties properties) {
+    internAtoms();
+
+    // Sending all the requests first...
+    QVector<Cookies> cookieList(idList.length());
+    for (int i = 0; i < idList.length(); i++) {
+        xcb_window_t window = idList[i];
+        auto& cookies = cookieList[i];
+
+        // Geometry is always requested, its reply tells whether the window exists
+        cookies.geometry = xcb_get_geometry(connection, window);
+
+        if (properties & NET::WMGeometry) {
+            cookies.position = xcb_translate_coordinates(connection, window, rootWindow, 0, 0);
+        }
+        if (properties & NET::WMState) {
+            cookies.state = requestProperty(window, netWmState, XCB_ATOM_ATOM, 32);
+        }
+        if (properties & NET::WMDesktop) {
+            cookies.desktop = requestProperty(window, netWmDesktop, XCB_ATOM_CARDINAL, 1);
+        }
+        if (properties & NET::WMWindowType) {
+            cookies.windowType = requestProperty(window, netWmWindowType, XCB_ATOM_ATOM, 32);
+        }
+        if (properties & NET::WMName) {
+            cookies.name = requestProperty(window, netWmName, utf8String, maxNameLength);
+        }
+    }
+
+    // ...and only then collecting the replies, all of them,
+    // even those of windows found to be gone in the meantime
+    QVector<WindowProperties> windowPropertiesList(idList.length());
+    QVector<bool> isValidList(idList.length());
+
+    for (int i = 0; i < idList.length(); i++) {
+        auto& cookies = cookieList[i];
+        auto& windowProperties = windowPropertiesList[i];
+
+        xcb_generic_error_t* error = nullptr;
+        auto* geometryReply = xcb_get_geometry_reply(connection, cookies.geometry, &error);
+        bool isValid = geometryReply != nullptr;
+        free(error);
+
+        if (properties & NET::WMGeometry) {
+            error = nullptr;
+            auto* positionReply = xcb_translate_coordinates_reply(connection, cookies.position, &error);
+            if (positionReply && geometryReply) {
+                windowProperties.geometry = QRect(positionReply->dst_x, positionReply->dst_y,
+                                                  geometryReply->width, geometryReply->height);
+            } else {
+                isValid = false;
+            }
+            free(positionReply);
+            free(error);
+        }
+        free(geometryReply);
+
+        if (properties & NET::WMState) {
+            windowProperties.state = parseState(takeProperty(cookies.state));
+        }
+        if (properties & NET::WMDesktop) {
+            windowProperties.desktopNumber = parseDesktopNumber(takeProperty(cookies.desktop));
+        }
+        if (properties & NET::WMWindowType) {
+            windowProperties.windowType = parseWindowType(takeProperty(cookies.windowType));
+        }
+        if (properties & NET::WMName) {
+            // The name as set by the window, like KWindowInfo::name, without
+            // the suffixes the window manager adds to tell duplicates apart
+            windowProperties.name = QString::fromUtf8(takeProperty(cookies.name));
+        }
+
+        isValidList[i] = isValid;
+    }
+
+    // Windows without a UTF-8 name are rare, so their legacy name is only
+    // requested afterwards, in a batch of its own, in any encoding
+    if (properties & NET::WMName) {
+        QVector<int> fallbackIndexList;
+        QVector<xcb_get_property_cookie_t> fallbackCookieList;
+        for (int i = 0; i < idList.length(); i++) {
+            if (isValidList[i] && windowPropertiesList[i].name.isEmpty()) {
+                fallbackIndexList << i;
+                fallbackCookieList << requestProperty(idList[i], XCB_ATOM_WM_NAME,
+                                                      XCB_GET_PROPERTY_TYPE_ANY, maxNameLength);
+            }
+        }
+
+        for (int j = 0; j < fallbackIndexList.length(); j++) {
+            xcb_atom_t type = XCB_ATOM_NONE;
+            QByteArray name = takeProperty(fallbackCookieList[j], &type);
+            windowPropertiesList[fallbackIndexList[j]].name = parseName(name, type);
+        }
+    }
+
+    QHash<WId, WindowProperties> windowPropertiesHash;
+    windowPropertiesHash.reserve(idList.length());
+    for (int i = 0; i < idList.length(); i++) {
+        if (isValidList[i]) {
+            windowPropertiesHash.insert(idList[i], windowPropertiesList[i]);
+        }
+    }
+
+    return windowPropertiesHash;
+}
+
+// Interning all the atoms at once, so it only costs a single round trip
+void X11WindowEnumerator::internAtoms() {
+    if (isInterned) {
+        return;
+    }
+
+    QList<QByteArray> nameList = { "_NET_WM_STATE", "_NET_WM_DESKTOP", "_NET_WM_WINDOW_TYPE",
+                                   "_NET_WM_NAME", "UTF8_STRING" };
+    for (auto& atomState : atomStateList) {
+        nameList << atomState.name;
+    }
+    for (auto& atomWindowType : atomWindowTypeList) {
+        nameList << atomWindowType.name;
+    }
+
+    QVector<xcb_intern_atom_cookie_t> cookieList;
+    for (auto& name : nameList) {
+        cookieList << xcb_intern_atom(connection, false, name.length(), name.constData());
+    }
+
+    QVector<xcb_atom_t> atomList;
+    for (auto& cookie : cookieList) {
+        auto* reply = xcb_intern_atom_reply(connection, cookie, nullptr);
+        atomList << (reply ? reply->atom : XCB_ATOM_NONE);
+        free(reply);
+    }
+
+    netWmState = atomList[0];
+    netWmDesktop = atomList[1];
+    netWmWindowType = atomList[2];
+    netWmName = atomList[3];
+    utf8String = atomList[4];
+
+    int n = 5;
+    for (auto& atomState : atomStateList) {
+        stateHash.insert(atomList[n++], atomState.state);
+    }
+    for (auto& atomWindowType : atomWindowTypeList) {
+        windowTypeHash.insert(atomList[n++], atomWindowType.windowType);
+    }
+    stateHash.remove(XCB_ATOM_NONE);
+    windowTypeHash.remove(XCB_ATOM_NONE);
+
+    isInterned = true;
+}
+
+xcb_get_property_cookie_t X11WindowEnumerator::requestProperty(xcb_window_t window, xcb_atom_t property,
+                                                               xcb_atom_t type, uint32_t length) {
+    return xcb_get_property(connection, false, window, property, type, 0, length);
+}
+
+QByteArray X11WindowEnumerator::takeProperty(xcb_get_property_cookie_t cookie, xcb_atom_t* type) {
+    QByteArray value;
+
+    xcb_generic_error_t* error = nullptr;
+    auto* reply = xcb_get_property_reply(connection, cookie, &error);
+    if (reply) {
+        if (type) {
+            *type = reply->type;
+        }
+        value = QByteArray(static_cast<const char*>(xcb_get_property_value(reply)),
+                           xcb_get_property_value_length(reply));
+        free(reply);
+    }
+    free(error);
+
+    return value;
+}
+
+NET::States X11WindowEnumerator::parseState(const QByteArray& value) const {
+    NET::States state;
+
+    int n = value.length() / sizeof(xcb_atom_t);
+    for (int i = 0; i < n; i++) {
+        xcb_atom_t atom;
+        memcpy(&atom, value.constData() + i * sizeof(xcb_atom_t), sizeof(xcb_atom_t));
+        state |= stateHash.value(atom, NET::State(0));
+    }
+
+    return state;
+}
+
+int X11WindowEnumerator::parseDesktopNumber(const QByteArray& value) const {
+    if (value.length() < int(sizeof(uint32_t))) {
+        return 0;
+    }
+
+    uint32_t desktop;
+    memcpy(&desktop, value.constData(), sizeof(uint32_t));
+
+    // Desktops are numbered from 0 in the property
+    return desktop == 0xFFFFFFFF ? int(NET::OnAllDesktops) : int(desktop) + 1;
+}
+
+NET::WindowType X11WindowEnumerator::parseWindowType(const QByteArray& value) const {
+    // Types are listed in the order of preference, the first known one wins
+    int n = value.length() / sizeof(xcb_atom_t);
+    for (int i = 0; i < n; i++) {
+        xcb_atom_t atom;
+        memcpy(&atom, value.constData() + i * sizeof(xcb_atom_t), sizeof(xcb_atom_t));
+        if (windowTypeHash.contains(atom)) {
+            return windowTypeHash.value(atom);
+        }
+    }
+
+    return NET::Unknown;
+}
+
+QString X11WindowEnumerator::parseName(const QByteArray& value, xcb_atom_t type) const {
+    if (type == utf8String) {
+        return QString::fromUtf8(value);
+    }
+    if (type == XCB_ATOM_STRING) {
+        return QString::fromLatin1(value);
+    }
+
+    // COMPOUND_TEXT and the like, which is what the locale encoding gives
+    // for the common case of a title without escape sequences
+    return QString::fromLocal8Bit(value);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <KWindowSystem>
+
+#include <xcb/xcb.h>
+
+#include "WindowSystemBackend.hpp"
+
+// Reads window properties straight from the X server, sending the requests
+// for all the windows before waiting for any reply, so fetching a whole
+// stacking order costs about a single round trip instead of one per window
+class X11WindowEnumerator {
+public:
+    X11WindowEnumerator(xcb_connection_t* connection, xcb_window_t rootWindow);
+
+    // Supports WMState, WMDesktop, WMGeometry, WMWindowType and WMName,
+    // leaves out the windows that do not exist anymore
+    QHash<WId, WindowProperties> fetch(const QList<WId>& idList, NET::Properties properties);
+
+private:
+    xcb_connection_t* connection;
+    xcb_window_t rootWindow;
+
+    bool isInterned;
+    xcb_atom_t netWmState;
+    xcb_atom_t netWmDesktop;
+    xcb_atom_t netWmWindowType;
+    xcb_atom_t netWmName;
+    xcb_atom_t utf8String;
+    QHash<xcb_atom_t, NET::State> stateHash;
+    QHash<xcb_atom_t, NET::WindowType> windowTypeHash;
+
+    void internAtoms();
+
+    xcb_get_property_cookie_t requestProperty(xcb_window_t window, xcb_atom_t property,
+                                              xcb_atom_t type, uint32_t length);
+    QByteArray takeProperty(xcb_get_property_cookie_t cookie, xcb_atom_t* type = nullptr);
+
+    NET::States parseState(const QByteArray& value) const;
+    int parseDesktopNumber(const QByteArray& value) const;
+    NET::WindowType parseWindowType(const QByteArray& value) const;
+    QString parseName(const QByteArray& value, xcb_atom_t type) const;
+};
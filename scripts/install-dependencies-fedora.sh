@@ -1,2 +1,2 @@
 #!/bin/sh
-dnf install cmake extra-cmake-modules gcc-c++ qt5-qtbase-devel qt5-qtdeclarative-devel qt5-qtx11extras-devel kf5-plasma-devel kf5-kglobalaccel-devel kf5-kxmlgui-devel kf5-wayland kf5-wayland-devel qt5-qtwayland-devel plasma-workspace-wayland plasma-workspace-devel kf5-kitemmodels kf5-kitemmodels-devel
+dnf install cmake extra-cmake-modules gcc-c++ qt5-qtbase-devel qt5-qtdeclarative-devel qt5-qtx11extras-devel kf5-plasma-devel kf5-kglobalaccel-devel kf5-kxmlgui-devel kf5-wayland kf5-wayland-devel qt5-qtwayland-devel plasma-workspace-wayland plasma-workspace-devel kf5-kitemmodels kf5-kitemmodels-devel libxcb-devel
@@ -0,0 +1,201 @@
+// Checks the applet's reactions to window system events against FakeBackend,
+// without a display server, Plasma or KWin
+
+#include <QCoreApplication>
+#include <QtTest>
+
+#include "FakeBackend.hpp"
+#include "VirtualDesktopBar.hpp"
+#include "WindowNameParser.hpp"
+
+namespace {
+
+QVariant getDesktopData(VirtualDesktopBar& bar, int number, int role) {
+    auto* model = bar.getDesktopListModel();
+    return model->data(model->index(number - 1), role);
+}
+
+}
+
+class DesktopBarCoreTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void openingWindowOccupiesDesktop();
+    void closingLastWindowEmptiesDesktop();
+    void raisingWindowUpdatesActiveWindowName();
+    void removedDesktopStaysUntilReleased();
+    void unusableWindowNameRulesFallBackToDefault();
+    void movingDesktopTwiceAppliesBothMoves();
+    void openingWindowOccupiesDesktopWithoutScanner();
+    void scannedWindowsAreCountedInStats();
+    void dumpedStatsIncludeScannedWindows();
+};
+
+void DesktopBarCoreTest::openingWindowOccupiesDesktop() {
+    FakeBackend backend(2);
+    backend.drain();
+
+    auto core = QSharedPointer<DesktopBarCore>::create(&backend);
+    VirtualDesktopBar bar(core);
+    bar.requestDesktopInfoList();
+    backend.drain(core.data());
+
+    QVERIFY(getDesktopData(bar, 2, DesktopListModel::IsEmptyRole).toBool());
+
+    backend.addWindow(2, "Editor", QRect(0, 0, 800, 500));
+    backend.drain(core.data());
+
+    QVERIFY(!getDesktopData(bar, 2, DesktopListModel::IsEmptyRole).toBool());
+    QCOMPARE(getDesktopData(bar, 2, DesktopListModel::WindowCountRole).toInt(), 1);
+}
+
+void DesktopBarCoreTest::closingLastWindowEmptiesDesktop() {
+    FakeBackend backend(2);
+    WId id = backend.addWindow(2, "Editor", QRect(0, 0, 800, 500));
+    backend.drain();
+
+    auto core = QSharedPointer<DesktopBarCore>::create(&backend);
+    VirtualDesktopBar bar(core);
+    bar.requestDesktopInfoList();
+    backend.drain(core.data());
+
+    QVERIFY(!getDesktopData(bar, 2, DesktopListModel::IsEmptyRole).toBool());
+
+    backend.removeWindow(id);
+    backend.drain(core.data());
+
+    QVERIFY(getDesktopData(bar, 2, DesktopListModel::IsEmptyRole).toBool());
+}
+
+void DesktopBarCoreTest::raisingWindowUpdatesActiveWindowName() {
+    FakeBackend backend(2);
+    WId id = backend.addWindow(1, "Editor", QRect(0, 0, 800, 500));
+    backend.addWindow(1, "Terminal", QRect(0, 0, 800, 500));
+    backend.drain();
+
+    auto core = QSharedPointer<DesktopBarCore>::create(&backend);
+    VirtualDesktopBar bar(core);
+    bar.setProperty("windowNamesShown", true);
+    bar.requestDesktopInfoList();
+    backend.drain(core.data());
+
+    QCOMPARE(getDesktopData(bar, 1, DesktopListModel::ActiveWindowNameRole).toString(), QString("Terminal"));
+
+    backend.raiseWindow(id);
+    backend.drain(core.data());
+
+    QCOMPARE(getDesktopData(bar, 1, DesktopListModel::ActiveWindowNameRole).toString(), QString("Editor"));
+}
+
+void DesktopBarCoreTest::removedDesktopStaysUntilReleased() {
+    FakeBackend backend(3);
+    backend.drain();
+
+    auto core = QSharedPointer<DesktopBarCore>::create(&backend);
+    VirtualDesktopBar bar(core);
+    bar.setProperty("cfg_AnimationsEnable", true);
+    bar.requestDesktopInfoList();
+    backend.drain(core.data());
+
+    auto* model = bar.getDesktopListModel();
+    QString id = getDesktopData(bar, 3, DesktopListModel::IdRole).toString();
+
+    backend.setNumberOfDesktops(2);
+    backend.drain(core.data());
+
+    QCOMPARE(model->rowCount(), 3);
+    QVERIFY(getDesktopData(bar, 3, DesktopListModel::IsRemovedRole).toBool());
+
+    model->releaseRemovedRow(id);
+
+    QCOMPARE(model->rowCount(), 2);
+    QVERIFY(!getDesktopData(bar, 2, DesktopListModel::IsRemovedRole).toBool());
+}
+
+void DesktopBarCoreTest::unusableWindowNameRulesFallBackToDefault() {
+    WindowNameParser parser;
+    QVERIFY(parser.setRules("(unclosed\nno group"));
+    QCOMPARE(parser.parse("Notes - Editor"), QString("Editor"));
+
+    // Setting the same rules again changes nothing
+    QVERIFY(!parser.setRules("(unclosed\nno group"));
+}
+
+void DesktopBarCoreTest::movingDesktopTwiceAppliesBothMoves() {
+    FakeBackend backend(3);
+    WId id = backend.addWindow(1, "Editor", QRect(0, 0, 800, 500));
+    backend.drain();
+
+    DesktopBarCore core(&backend);
+    backend.drain(&core);
+
+    // The second move is made before the window manager applied the first one
+    core.moveDesktop(1, 2);
+    core.moveDesktop(2, 3);
+    backend.drain(&core);
+
+    QCOMPARE(backend.desktopName(1), QString("Desktop 2"));
+    QCOMPARE(backend.desktopName(2), QString("Desktop 3"));
+    QCOMPARE(backend.desktopName(3), QString("Desktop 1"));
+
+    WindowProperties windowProperties;
+    QVERIFY(backend.fetchWindow(id, NET::WMDesktop, windowProperties));
+    QCOMPARE(windowProperties.desktopNumber, 3);
+}
+
+void DesktopBarCoreTest::openingWindowOccupiesDesktopWithoutScanner() {
+    FakeBackend backend(2);
+    backend.setWindowScanningEnabled(false);
+    backend.drain();
+
+    auto core = QSharedPointer<DesktopBarCore>::create(&backend);
+    VirtualDesktopBar bar(core);
+    bar.requestDesktopInfoList();
+    backend.drain(core.data());
+
+    backend.addWindow(2, "Editor", QRect(0, 0, 800, 500));
+    backend.drain(core.data());
+
+    QVERIFY(!getDesktopData(bar, 2, DesktopListModel::IsEmptyRole).toBool());
+}
+
+void DesktopBarCoreTest::scannedWindowsAreCountedInStats() {
+    FakeBackend backend(2);
+    backend.drain();
+
+    auto core = QSharedPointer<DesktopBarCore>::create(&backend);
+    VirtualDesktopBar bar(core);
+    bar.requestDesktopInfoList();
+    backend.drain(core.data());
+    core->getStats()->reset();
+
+    backend.addWindow(2, "Notes - Editor", QRect(0, 0, 800, 500));
+    backend.drain(core.data());
+
+    auto summary = core->getStats()->getSummary();
+    QVERIFY(summary.value("xRoundTrips").toLongLong() > 0);
+    QVERIFY(summary.value("windowFetch").toMap().value("count").toLongLong() > 0);
+    QVERIFY(summary.value("titleParse").toMap().value("count").toLongLong() > 0);
+}
+
+void DesktopBarCoreTest::dumpedStatsIncludeScannedWindows() {
+    FakeBackend backend(2);
+    backend.drain();
+
+    DesktopBarCore core(&backend);
+    backend.drain(&core);
+    core.getStats()->reset();
+
+    backend.addWindow(2, "Notes - Editor", QRect(0, 0, 800, 500));
+    backend.drain(&core);
+
+    QTest::ignoreMessage(QtInfoMsg, QRegularExpression("^windowFetch +count +[1-9]"));
+    QTest::ignoreMessage(QtInfoMsg, QRegularExpression("^titleParse +count +[1-9]"));
+    QTest::ignoreMessage(QtInfoMsg, QRegularExpression("^xRoundTrips +[1-9]"));
+    core.getStats()->dump();
+}
+
+QTEST_GUILESS_MAIN(DesktopBarCoreTest)
+
+#include "DesktopBarCoreTest.moc"
@@ -0,0 +1,174 @@
+// Measures the cost of the applet's logic at scale against FakeBackend,
+// without a display server, Plasma or KWin:
+//
+//     virtualdesktopbar-benchmark [desktops] [windows] [iterations] [panels]
+
+#include <cstdio>
+#include <functional>
+#include <random>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include "FakeBackend.hpp"
+#include "VirtualDesktopBar.hpp"
+
+namespace {
+
+void run(const char* scenario, FakeBackend& backend, DesktopBarCore* core, VirtualDesktopBar& bar,
+         const std::function<void()>& script) {
+    bar.getStats()->reset();
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    script();
+    backend.drain(core);
+    double totalMsec = elapsedTimer.nsecsElapsed() / 1e6;
+
+    auto summary = bar.getStats()->getSummary();
+    auto refresh = summary.value("refresh").toMap();
+    auto windowIndex = summary.value("windowIndex").toMap();
+    auto modelUpdate = summary.value("modelUpdate").toMap();
+
+    printf("%-16s %9.2f ms  refreshes %5lld  coalesced %6lld  filtered %6lld  fetches %6lld  "
+           "refresh p50/p99 %8.1f/%8.1f us  index p50 %8.1f us  model p50 %8.1f us\n",
+           scenario, totalMsec,
+           summary.value("refreshes").toLongLong(),
+           summary.value("coalescedChanges").toLongLong(),
+           summary.value("filteredEvents").toLongLong(),
+           summary.value("xRoundTrips").toLongLong(),
+           refresh.value("p50").toDouble(), refresh.value("p99").toDouble(),
+           windowIndex.value("p50").toDouble(),
+           modelUpdate.value("p50").toDouble());
+}
+
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    auto arguments = app.arguments();
+    int numberOfDesktops = arguments.length() > 1 ? arguments[1].toInt() : 50;
+    int numberOfWindows = arguments.length() > 2 ? arguments[2].toInt() : 1000;
+    int iterations = arguments.length() > 3 ? arguments[3].toInt() : 100;
+    int numberOfPanels = arguments.length() > 4 ? qMax(1, arguments[4].toInt()) : 1;
+
+    printf("%d desktops, %d windows, %d iterations, %d panels\n\n",
+           numberOfDesktops, numberOfWindows, iterations, numberOfPanels);
+
+    // Fixed seed, so runs can be compared with each other
+    std::mt19937 generator(1);
+    auto randomInt = [&](int n) {
+        return int(generator() % n);
+    };
+
+    FakeBackend backend(numberOfDesktops);
+    QList<WId> windowList;
+    for (int i = 0; i < numberOfWindows; i++) {
+        // Half of the windows are placed on a second screen
+        QRect geometry(randomInt(2) * 1920 + randomInt(1000), randomInt(500), 800, 500);
+        windowList << backend.addWindow(1 + i % numberOfDesktops,
+                                        QString("Document %1 - Application %2").arg(i).arg(i % 17),
+                                        geometry);
+    }
+    backend.drain();
+
+    // All the panels share a single core, like applet instances in plasmashell
+    QList<VirtualDesktopBar*> barList;
+
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+    auto core = QSharedPointer<DesktopBarCore>::create(&backend);
+    for (int i = 0; i < numberOfPanels; i++) {
+        barList << new VirtualDesktopBar(core);
+        barList.last()->requestDesktopInfoList();
+    }
+    backend.drain(core.data());
+
+    auto* bar = barList.first();
+    printf("%-16s %9.2f ms\n", "startup", startupTimer.nsecsElapsed() / 1e6);
+
+    auto startupSummary = bar->getStats()->getSummary().value("startup").toMap();
+    for (auto phase : {"desktopTable", "firstSnapshot", "windowScan"}) {
+        printf("  %-14s %9.2f ms\n", phase, startupSummary.value(phase).toDouble());
+    }
+
+    // Title changes are filtered out unless the labels show window names
+    for (bool windowNamesShown : {false, true}) {
+        bar->setProperty("windowNamesShown", windowNamesShown);
+        backend.drain(core.data());
+
+        run(windowNamesShown ? "title storm" : "hidden titles", backend, core.data(), *bar, [&] {
+            for (int i = 0; i < iterations * 10; i++) {
+                backend.renameWindow(windowList[randomInt(windowList.length())],
+                                     QString("Document %1 - Application").arg(i));
+            }
+        });
+    }
+
+    run("urgency storm", backend, core.data(), *bar, [&] {
+        for (int i = 0; i < iterations; i++) {
+            WId id = windowList[randomInt(windowList.length())];
+            backend.setWindowUrgent(id, true);
+            backend.setWindowUrgent(id, false);
+        }
+    });
+
+    run("stacking storm", backend, core.data(), *bar, [&] {
+        for (int i = 0; i < iterations * 10; i++) {
+            backend.raiseWindow(windowList[randomInt(windowList.length())]);
+        }
+    });
+
+    run("refresh", backend, core.data(), *bar, [&] {
+        for (int i = 0; i < iterations; i++) {
+            backend.moveWindow(windowList[randomInt(windowList.length())],
+                               1 + randomInt(backend.numberOfDesktops()));
+            backend.drain(core.data());
+        }
+    });
+
+    bar->setProperty("screenName", "fake-screen-1");
+    bar->setProperty("cfg_MultipleScreensFilterOccupiedDesktops", true);
+    backend.drain(core.data());
+
+    run("screen refresh", backend, core.data(), *bar, [&] {
+        for (int i = 0; i < iterations; i++) {
+            backend.moveWindow(windowList[randomInt(windowList.length())],
+                               1 + randomInt(backend.numberOfDesktops()));
+            backend.drain(core.data());
+        }
+    });
+
+    bar->setProperty("cfg_MultipleScreensFilterOccupiedDesktops", false);
+    backend.drain(core.data());
+
+    run("reorder", backend, core.data(), *bar, [&] {
+        for (int i = 0; i < iterations; i++) {
+            bar->moveDesktop(1 + randomInt(backend.numberOfDesktops()),
+                             1 + randomInt(backend.numberOfDesktops()));
+            backend.drain(core.data());
+        }
+    });
+
+    bar->setProperty("cfg_DynamicDesktopsEnable", true);
+    backend.drain(core.data());
+
+    // Emptying most of the desktops at once makes the applet remove all of them
+    run("dynamic remove", backend, core.data(), *bar, [&] {
+        for (int i = 0; i < windowList.length(); i++) {
+            backend.moveWindow(windowList[i], 1 + i % 2);
+        }
+    });
+
+    // Occupying the only empty desktop makes the applet add another one
+    run("dynamic add", backend, core.data(), *bar, [&] {
+        for (int i = 0; i < iterations && i < windowList.length(); i++) {
+            backend.moveWindow(windowList[i], backend.numberOfDesktops());
+            backend.drain(core.data());
+        }
+    });
+
+    qDeleteAll(barList);
+    return 0;
+}
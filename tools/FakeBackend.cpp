@@ -0,0 +1,501 @@
+#include "FakeBackend.hpp"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QTimer>
+
+#include "DesktopBarCore.hpp"
+
+FakeBackend::FakeBackend(int numberOfDesktops, int numberOfScreens, QObject* parent) : WindowSystemBackend(parent),
+        currentDesktopNumber(1),
+        nextWindowId(0x1000000),
+        nextDesktopId(1),
+        pendingEventCount(0),
+        isWindowScanningEnabled(true),
+        isDesktopManagerScripted(false) {
+
+    for (int i = 1; i <= qMax(1, numberOfDesktops); i++) {
+        Desktop desktop;
+        desktop.id = QString("fake-desktop-%1").arg(nextDesktopId++);
+        desktop.name = QString("Desktop %1").arg(i);
+        desktopList << desktop;
+    }
+
+    for (int i = 0; i < qMax(1, numberOfScreens); i++) {
+        ScreenInfo screenInfo;
+        screenInfo.name = QString("fake-screen-%1").arg(i);
+        screenInfo.geometry = QRect(i * 1920, 0, 1920, 1080);
+        screenInfoList << screenInfo;
+    }
+}
+
+int FakeBackend::currentDesktop() const {
+    return currentDesktopNumber;
+}
+
+int FakeBackend::numberOfDesktops() const {
+    return desktopList.length();
+}
+
+QString FakeBackend::desktopName(int number) const {
+    if (number < 1 || number > desktopList.length()) {
+        return QString();
+    }
+    return desktopList[number - 1].name;
+}
+
+QList<WId> FakeBackend::windows() const {
+    return windowHash.keys();
+}
+
+QList<WId> FakeBackend::stackingOrder() const {
+    return stackingOrderList;
+}
+
+QList<ScreenInfo> FakeBackend::screens() const {
+    return screenInfoList;
+}
+
+bool FakeBackend::fetchWindow(WId id, NET::Properties properties, WindowProperties& windowProperties) {
+    QMutexLocker locker(&windowMutex);
+
+    auto it = windowHash.constFind(id);
+    if (it == windowHash.constEnd()) {
+        return false;
+    }
+
+    if (properties & NET::WMState) {
+        windowProperties.state = it->state;
+    }
+    if (properties & NET::WMDesktop) {
+        windowProperties.desktopNumber = it->desktopNumber;
+    }
+    if (properties & NET::WMGeometry) {
+        windowProperties.geometry = it->geometry;
+    }
+    if (properties & NET::WMWindowType) {
+        windowProperties.windowType = it->windowType;
+    }
+    if (properties & NET::WMName) {
+        windowProperties.name = it->name;
+    }
+    return true;
+}
+
+WindowSystemBackend::WindowFetchFunction FakeBackend::createWindowFetchFunction() {
+    if (!isWindowScanningEnabled) {
+        return nullptr;
+    }
+
+    return [this](const QList<WId>& idList, NET::Properties properties) {
+        return fetchWindows(idList, properties);
+    };
+}
+
+void FakeBackend::setWindowScanningEnabled(bool isEnabled) {
+    isWindowScanningEnabled = isEnabled;
+}
+
+void FakeBackend::setCurrentDesktop(int number) {
+    if (number < 1 || number > desktopList.length() || number == currentDesktopNumber) {
+        return;
+    }
+
+    currentDesktopNumber = number;
+    post([this, number] { emit currentDesktopChanged(number); });
+}
+
+void FakeBackend::setNumberOfDesktops(int numberOfDesktops) {
+    numberOfDesktops = qMax(1, numberOfDesktops);
+    if (numberOfDesktops == desktopList.length()) {
+        return;
+    }
+
+    while (desktopList.length() < numberOfDesktops) {
+        insertDesktop(desktopList.length() + 1);
+    }
+    while (desktopList.length() > numberOfDesktops) {
+        eraseDesktop(desktopList.length());
+    }
+
+    post([this] { emit numberOfDesktopsChanged(desktopList.length()); });
+}
+
+void FakeBackend::setDesktopName(int number, const QString& name) {
+    if (number < 1 || number > desktopList.length()) {
+        return;
+    }
+
+    desktopList[number - 1].name = name;
+
+    auto desktopInfo = getDesktopInfo(number);
+    post([this, desktopInfo] {
+        if (!isDesktopManagerScripted) {
+            emit desktopDataChanged(desktopInfo);
+        }
+        emit desktopNamesChanged();
+    });
+}
+
+void FakeBackend::commit(X11Batch& batch) {
+    for (auto& windowMove : batch.getWindowMoveList()) {
+        moveWindow(windowMove.first, windowMove.second);
+    }
+
+    if (batch.hasDesktopNames()) {
+        auto& desktopNameList = batch.getDesktopNameList();
+        for (int i = 0; i < desktopNameList.length() && i < desktopList.length(); i++) {
+            desktopList[i].name = desktopNameList[i];
+        }
+        post([this] { emit desktopNamesChanged(); });
+    }
+
+    if (batch.getNumberOfDesktops() > 0) {
+        setNumberOfDesktops(batch.getNumberOfDesktops());
+    }
+
+    if (batch.getCurrentDesktopNumber() > 0) {
+        setCurrentDesktop(batch.getCurrentDesktopNumber());
+    }
+
+    batch.clear();
+}
+
+void FakeBackend::fetchDesktops(DesktopListCallback callback) {
+    if (isDesktopManagerScripted) {
+        if (fetchResultList.isEmpty()) {
+            fetchCallbackList << callback;
+        } else {
+            auto result = fetchResultList.takeFirst();
+            answerFetch(callback, result.first, result.second);
+        }
+        return;
+    }
+
+    post([this, callback] {
+        auto desktopInfoList = getDesktopInfoList();
+        emit desktopsFetched(true, desktopInfoList);
+        callback(true, desktopInfoList);
+    });
+}
+
+void FakeBackend::removeDesktop(const QString& id, ResultCallback callback) {
+    if (isDesktopManagerScripted) {
+        Request request{ id, QString(), callback };
+        if (removeResultList.isEmpty()) {
+            removeRequestList << request;
+        } else {
+            answerRemove(request, removeResultList.takeFirst());
+        }
+        return;
+    }
+
+    post([this, id, callback] {
+        for (int i = 0; i < desktopList.length(); i++) {
+            if (desktopList[i].id == id && desktopList.length() > 1) {
+                eraseDesktop(i + 1);
+                post([this] { emit numberOfDesktopsChanged(desktopList.length()); });
+                emit desktopRemoveFinished(id, true);
+                callback(true);
+                return;
+            }
+        }
+        emit desktopRemoveFinished(id, false);
+        callback(false);
+    });
+}
+
+void FakeBackend::renameDesktop(const QString& id, const QString& name, ResultCallback callback) {
+    if (isDesktopManagerScripted) {
+        Request request{ id, name, callback };
+        if (renameResultList.isEmpty()) {
+            renameRequestList << request;
+        } else {
+            answerRename(request, renameResultList.takeFirst());
+        }
+        return;
+    }
+
+    post([this, id, name, callback] {
+        for (int i = 0; i < desktopList.length(); i++) {
+            if (desktopList[i].id == id) {
+                setDesktopName(i + 1, name);
+                emit desktopRenameFinished(id, name, true);
+                callback(true);
+                return;
+            }
+        }
+        emit desktopRenameFinished(id, name, false);
+        callback(false);
+    });
+}
+
+WId FakeBackend::addWindow(int desktopNumber, const QString& name, const QRect& geometry) {
+    WindowProperties windowProperties;
+    windowProperties.desktopNumber = desktopNumber;
+    windowProperties.geometry = geometry;
+    windowProperties.windowType = NET::Normal;
+    windowProperties.name = name;
+    return addWindow(windowProperties);
+}
+
+WId FakeBackend::addWindow(const WindowProperties& windowProperties) {
+    WId id = nextWindowId++;
+
+    {
+        QMutexLocker locker(&windowMutex);
+        windowHash.insert(id, windowProperties);
+    }
+    stackingOrderList << id;
+
+    post([this, id] {
+        emit windowAdded(id);
+        emit stackingOrderChanged();
+    });
+
+    return id;
+}
+
+void FakeBackend::removeWindow(WId id) {
+    {
+        QMutexLocker locker(&windowMutex);
+        if (!windowHash.remove(id)) {
+            return;
+        }
+    }
+    stackingOrderList.removeOne(id);
+
+    post([this, id] {
+        emit windowRemoved(id);
+        emit stackingOrderChanged();
+    });
+}
+
+void FakeBackend::moveWindow(WId id, int desktopNumber) {
+    if (!windowHash.contains(id)) {
+        return;
+    }
+    setWindowDesktop(id, desktopNumber);
+}
+
+void FakeBackend::renameWindow(WId id, const QString& name) {
+    auto it = windowHash.find(id);
+    if (it == windowHash.end()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&windowMutex);
+        it->name = name;
+    }
+    post([this, id] { emit windowChanged(id, NET::WMName | NET::WMVisibleName, NET::Properties2()); });
+}
+
+void FakeBackend::setWindowUrgent(WId id, bool isUrgent) {
+    auto it = windowHash.find(id);
+    if (it == windowHash.end()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&windowMutex);
+        if (isUrgent) {
+            it->state |= NET::DemandsAttention;
+        } else {
+            it->state &= ~NET::DemandsAttention;
+        }
+    }
+    post([this, id] { emit windowChanged(id, NET::WMState, NET::Properties2()); });
+}
+
+void FakeBackend::raiseWindow(WId id) {
+    if (!stackingOrderList.removeOne(id)) {
+        return;
+    }
+
+    stackingOrderList << id;
+    post([this] { emit stackingOrderChanged(); });
+}
+
+void FakeBackend::changeWindow(WId id, const WindowProperties& windowProperties, NET::Properties properties,
+                               NET::Properties reportedProperties, NET::Properties2 reportedProperties2) {
+    auto it = windowHash.find(id);
+    if (it == windowHash.end()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&windowMutex);
+        it->copy(windowProperties, properties);
+    }
+    post([this, id, reportedProperties, reportedProperties2] {
+        emit windowChanged(id, reportedProperties, reportedProperties2);
+    });
+}
+
+void FakeBackend::setStackingOrder(const QList<WId>& idList) {
+    stackingOrderList.clear();
+    for (WId id : idList) {
+        if (windowHash.contains(id)) {
+            stackingOrderList << id;
+        }
+    }
+    post([this] { emit stackingOrderChanged(); });
+}
+
+void FakeBackend::setScreens(const QList<ScreenInfo>& screenInfoList) {
+    this->screenInfoList = screenInfoList;
+    post([this] { emit screensChanged(); });
+}
+
+void FakeBackend::setDesktopManagerScripted(bool isScripted) {
+    isDesktopManagerScripted = isScripted;
+}
+
+void FakeBackend::reportDesktopCreated(const DesktopInfo& desktopInfo) {
+    post([this, desktopInfo] { emit desktopCreated(desktopInfo); });
+}
+
+void FakeBackend::reportDesktopRemoved(const QString& id) {
+    if (!isDesktopManagerScripted) {
+        post([this, id] { emit desktopRemoved(id); });
+    }
+}
+
+void FakeBackend::reportDesktopDataChanged(const DesktopInfo& desktopInfo) {
+    post([this, desktopInfo] { emit desktopDataChanged(desktopInfo); });
+}
+
+void FakeBackend::reportDesktopsChanged(const QList<DesktopInfo>& desktopInfoList) {
+    post([this, desktopInfoList] { emit desktopsChanged(desktopInfoList); });
+}
+
+void FakeBackend::reportDesktopsFetched(bool isValid, const QList<DesktopInfo>& desktopInfoList) {
+    if (fetchCallbackList.isEmpty()) {
+        fetchResultList << qMakePair(isValid, desktopInfoList);
+    } else {
+        answerFetch(fetchCallbackList.takeFirst(), isValid, desktopInfoList);
+    }
+}
+
+void FakeBackend::reportDesktopRemoveFinished(bool isSuccessful) {
+    if (removeRequestList.isEmpty()) {
+        removeResultList << isSuccessful;
+    } else {
+        answerRemove(removeRequestList.takeFirst(), isSuccessful);
+    }
+}
+
+void FakeBackend::reportDesktopRenameFinished(bool isSuccessful) {
+    if (renameRequestList.isEmpty()) {
+        renameResultList << isSuccessful;
+    } else {
+        answerRename(renameRequestList.takeFirst(), isSuccessful);
+    }
+}
+
+void FakeBackend::answerFetch(DesktopListCallback callback, bool isValid, const QList<DesktopInfo>& desktopInfoList) {
+    post([this, callback, isValid, desktopInfoList] {
+        emit desktopsFetched(isValid, desktopInfoList);
+        callback(isValid, desktopInfoList);
+    });
+}
+
+void FakeBackend::answerRemove(const Request& request, bool isSuccessful) {
+    post([this, request, isSuccessful] {
+        emit desktopRemoveFinished(request.id, isSuccessful);
+        request.callback(isSuccessful);
+    });
+}
+
+void FakeBackend::answerRename(const Request& request, bool isSuccessful) {
+    post([this, request, isSuccessful] {
+        emit desktopRenameFinished(request.id, request.name, isSuccessful);
+        request.callback(isSuccessful);
+    });
+}
+
+bool FakeBackend::isIdle() const {
+    return pendingEventCount == 0;
+}
+
+void FakeBackend::drain(DesktopBarCore* core) {
+    int idlePassCount = 0;
+    while (idlePassCount < 3) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+        idlePassCount = isIdle() && (!core || core->isIdle()) ? idlePassCount + 1 : 0;
+    }
+}
+
+void FakeBackend::post(std::function<void()> event) {
+    pendingEventCount++;
+    QTimer::singleShot(0, this, [this, event] {
+        pendingEventCount--;
+        event();
+    });
+}
+
+DesktopInfo FakeBackend::getDesktopInfo(int number) const {
+    DesktopInfo desktopInfo;
+    desktopInfo.number = number;
+    desktopInfo.id = desktopList[number - 1].id;
+    desktopInfo.name = desktopList[number - 1].name;
+    return desktopInfo;
+}
+
+QList<DesktopInfo> FakeBackend::getDesktopInfoList() const {
+    QList<DesktopInfo> desktopInfoList;
+    for (int i = 1; i <= desktopList.length(); i++) {
+        desktopInfoList << getDesktopInfo(i);
+    }
+    return desktopInfoList;
+}
+
+void FakeBackend::insertDesktop(int number) {
+    Desktop desktop;
+    desktop.id = QString("fake-desktop-%1").arg(nextDesktopId++);
+    desktop.name = QString("Desktop %1").arg(number);
+    desktopList.insert(number - 1, desktop);
+
+    if (!isDesktopManagerScripted) {
+        auto desktopInfo = getDesktopInfo(number);
+        post([this, desktopInfo] { emit desktopCreated(desktopInfo); });
+    }
+}
+
+void FakeBackend::eraseDesktop(int number) {
+    QString id = desktopList[number - 1].id;
+    desktopList.removeAt(number - 1);
+
+    // Like KWin, windows of the removed desktop go to the one taking its place
+    for (auto it = windowHash.begin(); it != windowHash.end(); it++) {
+        int desktopNumber = it->desktopNumber;
+        if (desktopNumber == NET::OnAllDesktops || desktopNumber < number) {
+            continue;
+        }
+        setWindowDesktop(it.key(), qMin(desktopNumber == number ? number : desktopNumber - 1,
+                                        desktopList.length()));
+    }
+
+    if (!isDesktopManagerScripted) {
+        post([this, id] { emit desktopRemoved(id); });
+    }
+
+    if (currentDesktopNumber > desktopList.length()) {
+        currentDesktopNumber = desktopList.length();
+        post([this] { emit currentDesktopChanged(currentDesktopNumber); });
+    }
+}
+
+void FakeBackend::setWindowDesktop(WId id, int desktopNumber) {
+    auto it = windowHash.find(id);
+    if (it->desktopNumber == desktopNumber) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&windowMutex);
+        it->desktopNumber = desktopNumber;
+    }
+    post([this, id] { emit windowChanged(id, NET::WMDesktop, NET::Properties2()); });
+}
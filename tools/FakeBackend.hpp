@@ -0,0 +1,130 @@
+#pragma once
+
+#include <functional>
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+#include "WindowSystemBackend.hpp"
+
+class DesktopBarCore;
+
+// In-memory window system and desktop manager, delivering its signals
+// and replies asynchronously, the way X events and D-Bus replies arrive
+class FakeBackend : public WindowSystemBackend {
+    Q_OBJECT
+
+public:
+    // Screens are 1920x1080 and placed side by side
+    FakeBackend(int numberOfDesktops, int numberOfScreens = 2, QObject* parent = nullptr);
+
+    int currentDesktop() const override;
+    int numberOfDesktops() const override;
+    QString desktopName(int number) const override;
+    QList<WId> windows() const override;
+    QList<WId> stackingOrder() const override;
+    QList<ScreenInfo> screens() const override;
+
+    // Safe to call from another thread, so the applet scans windows on
+    // a worker thread like it does with KWinBackend, unless disabled
+    bool fetchWindow(WId id, NET::Properties properties, WindowProperties& windowProperties) override;
+    WindowFetchFunction createWindowFetchFunction() override;
+    void setWindowScanningEnabled(bool isEnabled);
+
+    void setCurrentDesktop(int number) override;
+    void setNumberOfDesktops(int numberOfDesktops) override;
+    void setDesktopName(int number, const QString& name) override;
+    void commit(X11Batch& batch) override;
+
+    void fetchDesktops(DesktopListCallback callback) override;
+    void removeDesktop(const QString& id, ResultCallback callback) override;
+    void renameDesktop(const QString& id, const QString& name, ResultCallback callback) override;
+
+    // Scripting the window system, as if clients and the user did it
+    WId addWindow(int desktopNumber, const QString& name, const QRect& geometry);
+    void removeWindow(WId id);
+    void moveWindow(WId id, int desktopNumber);
+    void renameWindow(WId id, const QString& name);
+    void setWindowUrgent(WId id, bool isUrgent);
+    void raiseWindow(WId id);
+
+    // Reproducing a recorded session, windows get ids of their own
+    WId addWindow(const WindowProperties& windowProperties);
+    void changeWindow(WId id, const WindowProperties& windowProperties, NET::Properties properties,
+                      NET::Properties reportedProperties, NET::Properties2 reportedProperties2);
+    void setStackingOrder(const QList<WId>& idList);
+    void setScreens(const QList<ScreenInfo>& screenInfoList);
+
+    // With the desktop manager scripted, it only sends the signals reported
+    // below, not the ones the fake's own changes would cause, and answers
+    // requests with the reported results, in order, changing nothing itself
+    void setDesktopManagerScripted(bool isScripted);
+    void reportDesktopCreated(const DesktopInfo& desktopInfo);
+    void reportDesktopRemoved(const QString& id);
+    void reportDesktopDataChanged(const DesktopInfo& desktopInfo);
+    void reportDesktopsChanged(const QList<DesktopInfo>& desktopInfoList);
+    void reportDesktopsFetched(bool isValid, const QList<DesktopInfo>& desktopInfoList);
+    void reportDesktopRemoveFinished(bool isSuccessful);
+    void reportDesktopRenameFinished(bool isSuccessful);
+
+    // Whether all the signals and replies were delivered
+    bool isIdle() const;
+
+    // Delivers events until neither the fake nor the given core, windows
+    // scanned on its worker thread included, has anything left to do
+    void drain(DesktopBarCore* core = nullptr);
+
+private:
+    class Desktop {
+    public:
+        QString id;
+        QString name;
+    };
+
+    QList<Desktop> desktopList;
+    QList<ScreenInfo> screenInfoList;
+    int currentDesktopNumber;
+    QHash<WId, WindowProperties> windowHash;
+
+    // Guards the windows against fetches from the worker thread,
+    // only taken to change them, as they are only changed on this one
+    QMutex windowMutex;
+    bool isWindowScanningEnabled;
+    QList<WId> stackingOrderList;
+    WId nextWindowId;
+    int nextDesktopId;
+    int pendingEventCount;
+
+    void post(std::function<void()> event);
+
+    class Request {
+    public:
+        QString id;
+        QString name;
+        ResultCallback callback;
+    };
+
+    // Requests and results of the scripted desktop manager not matched yet,
+    // only one list of each pair is non-empty at a time
+    bool isDesktopManagerScripted;
+    QList<DesktopListCallback> fetchCallbackList;
+    QList<QPair<bool, QList<DesktopInfo>>> fetchResultList;
+    QList<Request> removeRequestList;
+    QList<bool> removeResultList;
+    QList<Request> renameRequestList;
+    QList<bool> renameResultList;
+
+    void answerFetch(DesktopListCallback callback, bool isValid, const QList<DesktopInfo>& desktopInfoList);
+    void answerRemove(const Request& request, bool isSuccessful);
+    void answerRename(const Request& request, bool isSuccessful);
+
+    DesktopInfo getDesktopInfo(int number) const;
+    QList<DesktopInfo> getDesktopInfoList() const;
+
+    void insertDesktop(int number);
+    void eraseDesktop(int number);
+    void setWindowDesktop(WId id, int desktopNumber);
+};
@@ -0,0 +1,273 @@
+// Replays a trace of what the window system reported, recorded by running
+// plasmashell with VIRTUAL_DESKTOP_BAR_TRACE set to a file path, through
+// the applet's logic against FakeBackend, without a display server:
+//
+//     virtualdesktopbar-replay trace [burst gap in ms] [panels]
+//
+// Events recorded less than the burst gap apart are delivered one after
+// another without waiting, later ones only once everything is processed,
+// so the same trace gives comparable numbers across builds. Requests to the
+// desktop manager get the recorded results, in the order they were made
+
+#include <algorithm>
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QVector>
+
+#include "FakeBackend.hpp"
+#include "TraceRecorder.hpp"
+#include "VirtualDesktopBar.hpp"
+
+namespace {
+
+// Delivers the signals of a single event, and whatever runs right away
+void deliver(FakeBackend& backend) {
+    while (!backend.isIdle()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+    }
+}
+
+class Cost {
+public:
+    QVector<qint64> sampleList;
+    qint64 total = 0;
+
+    void add(qint64 nsecs) {
+        sampleList << nsecs;
+        total += nsecs;
+    }
+
+    double percentile(double p) const {
+        if (sampleList.isEmpty()) {
+            return 0;
+        }
+        QVector<qint64> sortedSampleList = sampleList;
+        int n = qBound(0, int(p * (sortedSampleList.length() - 1) + 0.5), sortedSampleList.length() - 1);
+        std::nth_element(sortedSampleList.begin(), sortedSampleList.begin() + n, sortedSampleList.end());
+        return sortedSampleList[n];
+    }
+};
+
+void printCost(const QString& name, const Cost& cost) {
+    printf("%-16s %8d  total %9.2f ms  mean %8.1f us  p50 %8.1f us  p99 %8.1f us\n",
+           qPrintable(name), cost.sampleList.length(), cost.total / 1e6,
+           cost.sampleList.isEmpty() ? 0.0 : cost.total / 1e3 / cost.sampleList.length(),
+           cost.percentile(0.50) / 1e3, cost.percentile(0.99) / 1e3);
+}
+
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    auto arguments = app.arguments();
+    if (arguments.length() < 2) {
+        fprintf(stderr, "usage: virtualdesktopbar-replay trace [burst gap in ms] [panels]\n");
+        return 1;
+    }
+    double burstGap = arguments.length() > 2 ? arguments[2].toDouble() : 1.0;
+    int numberOfPanels = arguments.length() > 3 ? qMax(1, arguments[3].toInt()) : 1;
+
+    QFile file(arguments[1]);
+    if (!file.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "cannot open %s\n", qPrintable(arguments[1]));
+        return 1;
+    }
+
+    QList<QJsonObject> eventList;
+    while (!file.atEnd()) {
+        auto object = QJsonDocument::fromJson(file.readLine()).object();
+        if (!object.isEmpty()) {
+            eventList << object;
+        }
+    }
+
+    if (eventList.isEmpty() || eventList.first().value("event").toString() != "state") {
+        fprintf(stderr, "%s does not start with the recorded state\n", qPrintable(arguments[1]));
+        return 1;
+    }
+
+    // Recorded windows are mapped to the ones of the fake
+    auto state = eventList.takeFirst();
+    auto nameArray = state.value("names").toArray();
+
+    // The desktop manager's signals and replies are the recorded ones
+    FakeBackend backend(nameArray.count(), 1);
+    backend.setDesktopManagerScripted(true);
+    QHash<WId, WId> idHash;
+    auto mapIds = [&](const QJsonArray& array) {
+        QList<WId> idList;
+        for (WId id : TraceRecorder::idsFromJson(array)) {
+            if (idHash.contains(id)) {
+                idList << idHash.value(id);
+            }
+        }
+        return idList;
+    };
+
+    backend.setScreens(TraceRecorder::screensFromJson(state.value("screens").toArray()));
+    for (int i = 0; i < nameArray.count(); i++) {
+        backend.setDesktopName(i + 1, nameArray.at(i).toString());
+    }
+    backend.setCurrentDesktop(state.value("currentDesktop").toInt());
+
+    for (auto value : state.value("windows").toArray()) {
+        WId id;
+        WindowProperties windowProperties;
+        TraceRecorder::windowFromJson(value.toObject(), id, windowProperties);
+        idHash.insert(id, backend.addWindow(windowProperties));
+    }
+    backend.setStackingOrder(mapIds(state.value("ids").toArray()));
+    backend.drain();
+
+    double recordedMsec = eventList.isEmpty() ? 0 : eventList.last().value("time").toDouble();
+    printf("%d windows, %d desktops, %d events over %.2f s, burst gap %.2f ms, %d panels\n\n",
+           idHash.count(), nameArray.count(), eventList.length(), recordedMsec / 1000,
+           burstGap, numberOfPanels);
+
+    // All the panels share a single core, like applet instances in plasmashell
+    auto core = QSharedPointer<DesktopBarCore>::create(&backend);
+    QList<VirtualDesktopBar*> barList;
+
+    int refreshedSignalCount = 0;
+    int modelSignalCount = 0;
+    QObject::connect(core.data(), &DesktopBarCore::refreshed, [&] {
+        refreshedSignalCount++;
+    });
+
+    for (int i = 0; i < numberOfPanels; i++) {
+        auto* bar = new VirtualDesktopBar(core);
+        bar->setProperty("windowNamesShown", true);
+        bar->requestDesktopInfoList();
+        barList << bar;
+
+        auto* model = bar->getDesktopListModel();
+        auto countSignal = [&] {
+            modelSignalCount++;
+        };
+        QObject::connect(model, &QAbstractItemModel::dataChanged, countSignal);
+        QObject::connect(model, &QAbstractItemModel::rowsInserted, countSignal);
+        QObject::connect(model, &QAbstractItemModel::rowsRemoved, countSignal);
+        QObject::connect(model, &QAbstractItemModel::rowsMoved, countSignal);
+        QObject::connect(model, &QAbstractItemModel::modelReset, countSignal);
+    }
+    backend.drain(core.data());
+
+    core->getStats()->reset();
+    refreshedSignalCount = 0;
+    modelSignalCount = 0;
+
+    QMap<QString, Cost> costMap;
+    Cost burstCost;
+    double lastTime = 0;
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    for (auto& object : eventList) {
+        double time = object.value("time").toDouble();
+        if (time - lastTime > burstGap) {
+            QElapsedTimer elapsedTimer;
+            elapsedTimer.start();
+            backend.drain(core.data());
+            burstCost.add(elapsedTimer.nsecsElapsed());
+        }
+        lastTime = time;
+
+        QString event = object.value("event").toString();
+        QElapsedTimer elapsedTimer;
+        elapsedTimer.start();
+
+        if (event == "currentDesktop") {
+            backend.setCurrentDesktop(object.value("number").toInt());
+        } else if (event == "desktopCount") {
+            backend.setNumberOfDesktops(object.value("count").toInt());
+        } else if (event == "desktopNames") {
+            auto array = object.value("names").toArray();
+            for (int i = 0; i < array.count() && i < backend.numberOfDesktops(); i++) {
+                if (backend.desktopName(i + 1) != array.at(i).toString()) {
+                    backend.setDesktopName(i + 1, array.at(i).toString());
+                }
+            }
+        } else if (event == "windowAdded") {
+            WId id;
+            WindowProperties windowProperties;
+            TraceRecorder::windowFromJson(object.value("window").toObject(), id, windowProperties);
+            idHash.insert(id, backend.addWindow(windowProperties));
+        } else if (event == "windowRemoved") {
+            WId id = idHash.take(WId(object.value("id").toDouble()));
+            if (id) {
+                backend.removeWindow(id);
+            }
+        } else if (event == "windowChanged") {
+            WId id;
+            WindowProperties windowProperties;
+            auto properties = TraceRecorder::windowFromJson(object.value("window").toObject(), id, windowProperties);
+            if (idHash.contains(id)) {
+                backend.changeWindow(idHash.value(id), windowProperties, properties,
+                                     NET::Properties(object.value("properties").toInt()),
+                                     NET::Properties2(object.value("properties2").toInt()));
+            }
+        } else if (event == "stackingOrder") {
+            backend.setStackingOrder(mapIds(object.value("ids").toArray()));
+        } else if (event == "screens") {
+            backend.setScreens(TraceRecorder::screensFromJson(object.value("screens").toArray()));
+        } else if (event == "desktopCreated") {
+            backend.reportDesktopCreated(TraceRecorder::desktopFromJson(object.value("desktop").toObject()));
+        } else if (event == "desktopRemoved") {
+            backend.reportDesktopRemoved(object.value("id").toString());
+        } else if (event == "desktopDataChanged") {
+            backend.reportDesktopDataChanged(TraceRecorder::desktopFromJson(object.value("desktop").toObject()));
+        } else if (event == "desktopsChanged") {
+            backend.reportDesktopsChanged(TraceRecorder::desktopsFromJson(object.value("desktops").toArray()));
+        } else if (event == "desktopsFetched") {
+            backend.reportDesktopsFetched(object.value("valid").toBool(),
+                                          TraceRecorder::desktopsFromJson(object.value("desktops").toArray()));
+        } else if (event == "desktopRemoveFinished") {
+            backend.reportDesktopRemoveFinished(object.value("successful").toBool());
+        } else if (event == "desktopRenameFinished") {
+            backend.reportDesktopRenameFinished(object.value("successful").toBool());
+        } else {
+            continue;
+        }
+
+        deliver(backend);
+        costMap[event].add(elapsedTimer.nsecsElapsed());
+    }
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    backend.drain(core.data());
+    burstCost.add(elapsedTimer.nsecsElapsed());
+
+    double totalMsec = totalTimer.nsecsElapsed() / 1e6;
+
+    for (auto it = costMap.constBegin(); it != costMap.constEnd(); it++) {
+        printCost(it.key(), it.value());
+    }
+    printCost("(burst end)", burstCost);
+
+    auto summary = core->getStats()->getSummary();
+    auto refresh = summary.value("refresh").toMap();
+
+    printf("\n%-16s %9.2f ms\n", "total", totalMsec);
+    printf("refreshes %lld  coalesced %lld  filtered %lld  fetches %lld  refresh p50/p99 %8.1f/%8.1f us\n",
+           summary.value("refreshes").toLongLong(),
+           summary.value("coalescedChanges").toLongLong(),
+           summary.value("filteredEvents").toLongLong(),
+           summary.value("xRoundTrips").toLongLong(),
+           refresh.value("p50").toDouble(), refresh.value("p99").toDouble());
+    printf("signals: refreshed %d  model %d\n", refreshedSignalCount, modelSignalCount);
+
+    qDeleteAll(barList);
+    return 0;
+}